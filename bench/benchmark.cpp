@@ -0,0 +1,96 @@
+#include "benchmark.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include "enemy/movement.hpp"
+
+BenchmarkRunner::BenchmarkRunner(const std::string& filter, double min_time)
+    : filter_(filter), min_time_(min_time) {}
+
+bool BenchmarkRunner::IsEnabled(const std::string& name) const {
+  return name.find(filter_) != std::string::npos;
+}
+
+void BenchmarkRunner::Run(const std::string& name, long items,
+                          const std::function<void()>& function) {
+  if (!IsEnabled(name)) {
+    return;
+  }
+  typedef std::chrono::steady_clock Clock;
+  // Warm up the caches before timing anything
+  function();
+  long iterations = 1;
+  double elapsed = 0;
+  double cpu_elapsed = 0;
+  while (true) {
+    auto start = Clock::now();
+    std::clock_t cpu_start = std::clock();
+    for (long i = 0; i < iterations; i++) {
+      function();
+    }
+    elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    cpu_elapsed = double(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+    if (elapsed >= min_time_ || iterations >= 1000000000) {
+      break;
+    }
+    // Aim a bit past the minimum time so the next batch is usually the last
+    double scale = elapsed > 0 ? 1.4 * min_time_ / elapsed : 10;
+    iterations = std::max(iterations + 1,
+                          long(iterations * std::min(scale, 10.0)));
+  }
+
+  Result result = {name, iterations, elapsed * 1e9 / iterations,
+                   cpu_elapsed * 1e9 / iterations, items};
+  results_.push_back(result);
+  char line[256];
+  std::snprintf(line, sizeof(line), "%-48s %14.0f ns %10ld", name.c_str(),
+                result.real_time, iterations);
+  std::cout << line;
+  if (items > 0) {
+    std::cout << "  " << items / (result.real_time * 1e-9) << " items/s";
+  }
+  std::cout << std::endl;
+}
+
+bool BenchmarkRunner::WriteJson(const std::string& file_path) const {
+  std::ofstream os(file_path);
+  if (!os.is_open()) {
+    std::cout << "Failed to open " << file_path << std::endl;
+    return false;
+  }
+  char date[64];
+  std::time_t now = std::time(nullptr);
+  std::strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
+  os << "{\n";
+  os << "  \"context\": {\n";
+  os << "    \"date\": \"" << date << "\",\n";
+  os << "    \"executable\": \"td-bench\",\n";
+  os << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+  os << "    \"instruction_set\": \"" << Movement::GetInstructionSet()
+     << "\"\n";
+  os << "  },\n";
+  os << "  \"benchmarks\": [";
+  for (size_t i = 0; i < results_.size(); i++) {
+    const Result& result = results_[i];
+    os << (i == 0 ? "\n" : ",\n");
+    os << "    {\n";
+    os << "      \"name\": \"" << result.name << "\",\n";
+    os << "      \"run_name\": \"" << result.name << "\",\n";
+    os << "      \"run_type\": \"iteration\",\n";
+    os << "      \"iterations\": " << result.iterations << ",\n";
+    os << "      \"real_time\": " << result.real_time << ",\n";
+    os << "      \"cpu_time\": " << result.cpu_time << ",\n";
+    if (result.items > 0) {
+      os << "      \"items_per_second\": "
+         << result.items / (result.real_time * 1e-9) << ",\n";
+    }
+    os << "      \"time_unit\": \"ns\"\n";
+    os << "    }";
+  }
+  os << "\n  ]\n}\n";
+  return true;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+
+// Small benchmark harness. Each benchmark is run in batches that grow until a
+// batch takes at least the minimum time, and the time per run of the last
+// batch is reported. Results are written in the JSON format of Google
+// Benchmark so its comparison tools can be used on them.
+class BenchmarkRunner {
+ public:
+  BenchmarkRunner(const std::string& filter = "", double min_time = 0.5);
+  bool IsEnabled(const std::string& name) const;
+  // Runs the function repeatedly. Items is the amount of work a single run
+  // does, for example the number of enemies moved, and is used to report the
+  // throughput.
+  void Run(const std::string& name, long items,
+           const std::function<void()>& function);
+  bool WriteJson(const std::string& file_path) const;
+
+ private:
+  struct Result {
+    std::string name;
+    long iterations;
+    double real_time;
+    double cpu_time;
+    long items;
+  };
+
+  std::string filter_;
+  double min_time_;
+  std::vector<Result> results_;
+};
@@ -0,0 +1,492 @@
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "benchmark.hpp"
+#include "enemy/enemy_store.hpp"
+#include "enemy/movement.hpp"
+#include "map/map.hpp"
+#include "map/pathfinder.hpp"
+#include "simulation/job_system.hpp"
+#include "simulation/save_game.hpp"
+#include "simulation/simulation.hpp"
+
+// Reaches into Simulation so the target selection of a step can be measured
+// on its own, with the enemies added directly instead of spawned
+class SimulationBenchmark {
+ public:
+  static EnemyStore& GetEnemies(Simulation& simulation) {
+    return simulation.enemies_;
+  }
+  // Towers are ready to attack once enough steps have passed
+  static void SetStep(Simulation& simulation, unsigned long step) {
+    simulation.step_ = step;
+  }
+  // Returns how many of the ready towers found a target
+  static int SelectTargets(Simulation& simulation) {
+    simulation.SelectTargets();
+    return std::count_if(simulation.targets_.begin(),
+                         simulation.targets_.end(),
+                         [](int target) { return target != -1; });
+  }
+};
+
+namespace {
+struct BenchmarkMap {
+  std::string name;
+  // The map in the format of the map files
+  std::string text;
+  Map map;
+};
+
+// Generates a width x height map of open fields split by walls every eighth
+// column. The gaps in the walls alternate between the top and the bottom, so
+// the path winds through the whole map. Trees are scattered on the fields,
+// but not on the top and bottom rows to keep the gaps reachable.
+bool GenerateMap(int width, int height, BenchmarkMap& bench_map) {
+  for (unsigned seed = 1; seed <= 10; seed++) {
+    std::mt19937 rng(seed);
+    std::bernoulli_distribution tree(0.05);
+    std::ostringstream os;
+    for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++) {
+        bool wall = x % 8 == 7 && x < width - 1;
+        bool gap = (x / 8) % 2 == 0 ? y == height - 1 : y == 0;
+        if (x == 0 && y == 0) {
+          os << 'S';
+        } else if (x == width - 1 && y == height - 1) {
+          os << 'B';
+        } else if (wall && !gap) {
+          os << '0';
+        } else if (!wall && y != 0 && y != height - 1 && tree(rng)) {
+          os << 'T';
+        } else {
+          os << '#';
+        }
+      }
+      os << '\n';
+    }
+    bench_map.text = os.str();
+    bench_map.map = Map();
+    std::istringstream is(bench_map.text);
+    bench_map.map.Load(is);
+    if (!bench_map.map.GetPath().empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Spreads the enemies evenly along the path of the map
+void AddEnemies(const Map& map, int count, EnemyStore& enemies) {
+  auto path = map.GetPath();
+  std::mt19937 rng(count);
+  std::uniform_real_distribution<float> speed(1, 5);
+  for (int i = 0; i < count; i++) {
+    auto tile = path[size_t(i) * path.size() / count];
+    enemies.Add(Enemy(100, speed(rng), tile.first + 0.5f, tile.second + 0.5f,
+                      0, EnemyTypes(i % 5)));
+  }
+}
+
+// Finds tiles next to the path to place towers on
+std::vector<std::pair<int, int>> FindTowerSpots(const Map& map, int count) {
+  std::vector<std::pair<int, int>> spots;
+  auto path = map.GetPath();
+  for (int i = 0; i < count; i++) {
+    auto tile = path[size_t(i) * path.size() / count];
+    for (int dx = -1; dx <= 1; dx++) {
+      int x = tile.first + dx;
+      if (CanPlaceTower(Basic, map, x, tile.second)) {
+        spots.push_back({x, tile.second});
+        break;
+      }
+    }
+  }
+  return spots;
+}
+
+void BenchLoading(BenchmarkRunner& runner, const BenchmarkMap& bench_map) {
+  runner.Run("Map::Load/" + bench_map.name, 0, [&bench_map]() {
+    Map map;
+    std::istringstream is(bench_map.text);
+    map.Load(is);
+  });
+
+  if (!runner.IsEnabled("Map::LoadBundle/" + bench_map.name)) {
+    return;
+  }
+  auto bundle = boost::filesystem::temp_directory_path() /
+                boost::filesystem::unique_path("td-bench-%%%%%%%%.bundle");
+  if (!bench_map.map.SaveBundle(bundle.string())) {
+    return;
+  }
+  runner.Run("Map::LoadBundle/" + bench_map.name, 0, [&bundle]() {
+    Map map;
+    map.LoadBundle(bundle.string());
+  });
+  boost::filesystem::remove(bundle);
+}
+
+// Writes the map in the format of the map files
+std::string ToText(const Map& map) {
+  static const char TILE_CHARS[] = "#0TtdSBWVw";
+  std::string text;
+  for (int y = 0; y < map.GetHeight(); y++) {
+    for (int x = 0; x < map.GetWidth(); x++) {
+      text += TILE_CHARS[map(x, y)];
+    }
+    text += '\n';
+  }
+  return text;
+}
+
+// Compares the repaired distances and flow field of the map with a map loaded
+// from scratch. Only the tiles of the two paths may point elsewhere, when the
+// repaired search found another path of the same length.
+bool MatchesFreshMap(const Map& map, const std::string& name,
+                     const std::string& after) {
+  Map fresh;
+  std::istringstream is(ToText(map));
+  fresh.Load(is);
+  std::vector<bool> on_path(map.GetTiles().size());
+  for (auto& tile : map.GetPath()) {
+    on_path[tile.second * map.GetWidth() + tile.first] = true;
+  }
+  for (auto& tile : fresh.GetPath()) {
+    on_path[tile.second * map.GetWidth() + tile.first] = true;
+  }
+  for (size_t i = 0; i < on_path.size(); i++) {
+    std::pair<int, int> tile(i % map.GetWidth(), i / map.GetWidth());
+    if (map.GetDistance(tile) != fresh.GetDistance(tile) ||
+        (!on_path[i] && map.GetFlowField()[i] != fresh.GetFlowField()[i])) {
+      std::cout << "The repaired flow field of " << name << " differs at "
+                << tile.first << ", " << tile.second << " after " << after
+                << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+// Blocks and opens random tiles and checks the repaired flow field after each
+// change. Tiles on the path are left open so there always is one. Then the
+// base is walled in, which leaves no path, and opened again.
+bool CheckFlowField(const BenchmarkMap& bench_map) {
+  Map map = bench_map.map;
+  std::mt19937 rng(map.GetWidth());
+  std::uniform_int_distribution<int> tile_x(0, map.GetWidth() - 1);
+  std::uniform_int_distribution<int> tile_y(0, map.GetHeight() - 1);
+  for (int change = 0; change < 20; change++) {
+    int x = tile_x(rng);
+    int y = tile_y(rng);
+    TileTypes type = map(x, y);
+    const auto& path = map.GetPath();
+    if ((type != Path && type != Empty) ||
+        std::find(path.begin(), path.end(), std::make_pair(x, y)) !=
+            path.end()) {
+      continue;
+    }
+    map.SetTile(x, y, type == Path ? Empty : Path);
+    if (!map.RecalculatePath()) {
+      std::cout << "No path on " << bench_map.name << std::endl;
+      return false;
+    }
+    if (!MatchesFreshMap(map, bench_map.name,
+                         std::to_string(change + 1) + " changes")) {
+      return false;
+    }
+  }
+
+  auto base = map.GetPlayerBase();
+  std::vector<std::pair<int, int>> wall;
+  const int offsets[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+  for (auto& offset : offsets) {
+    int x = base.first + offset[0];
+    int y = base.second + offset[1];
+    if (x >= 0 && x < map.GetWidth() && y >= 0 && y < map.GetHeight() &&
+        map(x, y) == Path) {
+      wall.push_back({x, y});
+      map.SetTile(x, y, Empty);
+    }
+  }
+  // The spawn may be next to the base
+  if (wall.empty() || map.RecalculatePath()) return true;
+  if (!MatchesFreshMap(map, bench_map.name, "walling in the base")) {
+    return false;
+  }
+  for (auto& tile : wall) {
+    map.SetTile(tile.first, tile.second, Path);
+  }
+  if (!map.RecalculatePath()) {
+    std::cout << "No path on " << bench_map.name << std::endl;
+    return false;
+  }
+  return MatchesFreshMap(map, bench_map.name, "opening the base");
+}
+
+void BenchPathfinding(BenchmarkRunner& runner, BenchmarkMap& bench_map) {
+  const Map& map = bench_map.map;
+  runner.Run("Pathfinder::GetPath/" + bench_map.name, 0,
+             [&map]() { Pathfinder::GetPath(map); });
+
+  // Block a tile in the middle of the path and open it again, which makes
+  // the map repair the path and the flow field twice
+  auto path = bench_map.map.GetPath();
+  auto tile = path[path.size() / 2];
+  Map& repaired = bench_map.map;
+  repaired.SetTile(tile.first, tile.second, Empty);
+  bool detour = repaired.RecalculatePath();
+  repaired.SetTile(tile.first, tile.second, Path);
+  repaired.RecalculatePath();
+  if (detour) {
+    runner.Run("Map::RecalculatePath/" + bench_map.name, 0, [&]() {
+      repaired.SetTile(tile.first, tile.second, Empty);
+      repaired.RecalculatePath();
+      repaired.SetTile(tile.first, tile.second, Path);
+      repaired.RecalculatePath();
+    });
+  }
+}
+
+// Compares Movement::Step with the scalar reference bit by bit. The counts
+// cover every remainder of the 4 and 8 wide loops, and every third enemy is
+// already at its target.
+bool CheckMovement() {
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> position(-1024, 1024);
+  for (int count = 0; count <= 1000; count += count < 40 ? 1 : 97) {
+    std::vector<float> x(count), y(count), target_x(count), target_y(count),
+        speed(count);
+    for (int i = 0; i < count; i++) {
+      x[i] = position(rng);
+      y[i] = position(rng);
+      target_x[i] = i % 3 == 0 ? x[i] : position(rng);
+      target_y[i] = i % 3 == 0 ? y[i] : position(rng);
+      speed[i] = 1 + i % 5;
+    }
+    std::vector<float> scalar_x = x, scalar_y = y;
+    Movement::Step(x.data(), y.data(), target_x.data(), target_y.data(),
+                   speed.data(), count);
+    Movement::StepScalar(scalar_x.data(), scalar_y.data(), target_x.data(),
+                         target_y.data(), speed.data(), count);
+    if (count > 0 &&
+        (std::memcmp(x.data(), scalar_x.data(), count * sizeof(float)) != 0 ||
+         std::memcmp(y.data(), scalar_y.data(), count * sizeof(float)) != 0)) {
+      std::cout << "Movement::Step (" << Movement::GetInstructionSet()
+                << ") differs from the scalar loop with " << count
+                << " enemies" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+void BenchMovement(BenchmarkRunner& runner, int count) {
+  std::vector<float> x(count), y(count), target_x(count), target_y(count),
+      speed(count);
+  std::mt19937 rng(count);
+  std::uniform_real_distribution<float> position(0, 1024);
+  for (int i = 0; i < count; i++) {
+    x[i] = position(rng);
+    y[i] = position(rng);
+    target_x[i] = position(rng);
+    target_y[i] = position(rng);
+    speed[i] = 1 + i % 5;
+  }
+  std::string suffix = "/" + std::to_string(count);
+  runner.Run("Movement::StepScalar" + suffix, count, [&]() {
+    Movement::StepScalar(x.data(), y.data(), target_x.data(), target_y.data(),
+                         speed.data(), count);
+  });
+  runner.Run("Movement::Step" + suffix, count, [&]() {
+    Movement::Step(x.data(), y.data(), target_x.data(), target_y.data(),
+                   speed.data(), count);
+  });
+}
+
+void BenchEnemies(BenchmarkRunner& runner, JobSystem& jobs,
+                  const BenchmarkMap& bench_map, int count) {
+  const Map& map = bench_map.map;
+  std::string suffix = "/" + bench_map.name + "/" + std::to_string(count);
+  EnemyStore enemies;
+  AddEnemies(map, count, enemies);
+  runner.Run("EnemyStore::Move" + suffix, count,
+             [&map, &enemies]() { enemies.Move(map); });
+  runner.Run("EnemyStore::MoveParallel" + suffix, count, [&]() {
+    jobs.ParallelFor(count, 4096, [&map, &enemies](int begin, int end, int) {
+      enemies.Move(map, begin, end);
+    });
+  });
+  // The enemies are most of a saved game
+  runner.Run("EnemyStore::Save" + suffix, count, [&enemies]() {
+    SaveGame::Writer writer;
+    enemies.Save(writer);
+  });
+  SaveGame::Writer saved;
+  enemies.Save(saved);
+  SaveGame::Reader reader(saved.GetData());
+  runner.Run("EnemyStore::Load" + suffix, count, [&map, &reader]() {
+    reader.Rewind();
+    EnemyStore loaded;
+    loaded.Load(reader, map);
+  });
+}
+
+// The target selection of Simulation::FindEnemies with towers along the path
+// and every tower ready to attack
+void BenchTargeting(BenchmarkRunner& runner, JobSystem& jobs,
+                    const BenchmarkMap& bench_map, int count) {
+  std::string suffix = "/" + bench_map.name + "/" + std::to_string(count);
+  std::string name = "Simulation::SelectTargets" + suffix;
+  std::string parallel_name = "Simulation::SelectTargetsParallel" + suffix;
+  if (!runner.IsEnabled(name) && !runner.IsEnabled(parallel_name)) {
+    return;
+  }
+  TowerTable towers;
+  Simulation simulation(bench_map.map, Player("bench", 1, 1000000000), towers);
+  AddEnemies(bench_map.map, count, SimulationBenchmark::GetEnemies(simulation));
+  for (auto& spot : FindTowerSpots(bench_map.map, 100)) {
+    simulation.BuyTower(MakeTower(Basic, spot.first, spot.second, towers));
+  }
+  SimulationBenchmark::SetStep(simulation, 1000 * Simulation::STEPS_PER_SECOND);
+  int found = -1;
+  runner.Run(name, count, [&simulation, &found]() {
+    found = SimulationBenchmark::SelectTargets(simulation);
+  });
+  simulation.SetJobSystem(&jobs);
+  runner.Run(parallel_name, count, [&simulation, &found]() {
+    found = SimulationBenchmark::SelectTargets(simulation);
+  });
+  if (found == 0) {
+    std::cout << "No targets found on " << bench_map.name << std::endl;
+  }
+}
+
+// Starting a wave only queues its monster groups, so a wave of count enemies
+// costs the same to start as a small one
+void BenchWaves(BenchmarkRunner& runner, const BenchmarkMap& bench_map,
+                int count) {
+  std::string name = "Simulation::StartWave/" + std::to_string(count);
+  if (!runner.IsEnabled(name)) {
+    return;
+  }
+  Map map = bench_map.map;
+  WaveTable waves;
+  waves.AddWave();
+  waves.AddGroup({Standard, count, 100, 1, 0});
+  map.SetWaves(waves);
+  TowerTable towers;
+  runner.Run(name, count, [&map, &towers]() {
+    Simulation simulation(map, Player("bench", 1, 0), towers);
+    simulation.StartWave();
+  });
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string filter;
+  std::string json_path = "td-bench.json";
+  double min_time = 0.5;
+  int max_size = 1024;
+  int max_enemies = 100000;
+  int threads = std::thread::hardware_concurrency();
+  bool check_only = false;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--check") {
+      check_only = true;
+    } else if (arg == "--filter" && i + 1 < argc) {
+      filter = argv[++i];
+    } else if (arg == "--json" && i + 1 < argc) {
+      json_path = argv[++i];
+    } else if (arg == "--min-time" && i + 1 < argc) {
+      min_time = std::atof(argv[++i]);
+    } else if (arg == "--max-size" && i + 1 < argc) {
+      max_size = std::atoi(argv[++i]);
+    } else if (arg == "--max-enemies" && i + 1 < argc) {
+      max_enemies = std::atoi(argv[++i]);
+    } else if (arg == "--threads" && i + 1 < argc) {
+      threads = std::atoi(argv[++i]);
+    } else {
+      std::cout << "Usage: td-bench [--filter text] [--json file] "
+                   "[--min-time seconds] [--max-size tiles] "
+                   "[--max-enemies count] [--threads count] [--check]"
+                << std::endl;
+      return arg == "--help" ? 0 : 1;
+    }
+  }
+
+  std::vector<BenchmarkMap> maps;
+  maps.push_back(BenchmarkMap());
+  maps.back().name = "big_map";
+  maps.back().map.SetName("01");
+  maps.back().map.Load("big_map.txt");
+  std::ifstream big_map("maps/01/big_map.txt");
+  maps.back().text.assign(std::istreambuf_iterator<char>(big_map),
+                          std::istreambuf_iterator<char>());
+  if (maps.back().map.GetPath().empty()) {
+    std::cout << "Skipping big_map, run td-bench from the out directory"
+              << std::endl;
+    maps.pop_back();
+  }
+  for (int size = 64; size <= max_size; size *= 4) {
+    maps.push_back(BenchmarkMap());
+    maps.back().name = "generated_" + std::to_string(size);
+    if (!GenerateMap(size, size, maps.back())) {
+      std::cout << "Failed to generate a map of size " << size << std::endl;
+      maps.pop_back();
+    }
+  }
+  if (maps.empty()) {
+    return 1;
+  }
+
+  // The optimized code is checked against its reference first, --check only
+  // runs the checks
+  if (!CheckMovement()) {
+    return 1;
+  }
+  for (auto& bench_map : maps) {
+    // Loading the largest maps from scratch takes too long for a check
+    if (bench_map.map.GetWidth() * bench_map.map.GetHeight() <= 256 * 256 &&
+        !CheckFlowField(bench_map)) {
+      return 1;
+    }
+  }
+  if (check_only) {
+    std::cout << "All checks passed" << std::endl;
+    return 0;
+  }
+  BenchmarkRunner runner(filter, min_time);
+  JobSystem jobs(threads);
+
+  for (auto& bench_map : maps) {
+    BenchLoading(runner, bench_map);
+    BenchPathfinding(runner, bench_map);
+  }
+  for (int count = 100; count <= max_enemies; count *= 10) {
+    BenchMovement(runner, count);
+    // The shipped map and the largest generated one
+    BenchEnemies(runner, jobs, maps.front(), count);
+    BenchTargeting(runner, jobs, maps.front(), count);
+    if (maps.size() > 1) {
+      BenchEnemies(runner, jobs, maps.back(), count);
+      BenchTargeting(runner, jobs, maps.back(), count);
+    }
+  }
+  BenchWaves(runner, maps.front(), max_enemies);
+
+  if (!runner.WriteJson(json_path)) {
+    return 1;
+  }
+  std::cout << "Results written to " << json_path << std::endl;
+  return 0;
+}
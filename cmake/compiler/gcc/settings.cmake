@@ -22,6 +22,18 @@ endif()
 add_definitions(-DHAVE_SSE2 -D__SSE2__)
 message(STATUS "GCC: SFMT enabled, SSE2 flags forced")
 
+if(WITH_AVX)
+  set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -mavx")
+  set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -mavx")
+  message(STATUS "GCC: AVX enabled")
+endif()
+
+# Fused multiply-add changes the rounding of the simulation math, which would
+# make the vectorized and scalar code paths disagree
+set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -ffp-contract=off")
+set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -ffp-contract=off")
+message(STATUS "GCC: Floating point contraction disabled")
+
 if( WITH_WARNINGS )
   set(WARNING_FLAGS "-W -Wall -Wextra -Winit-self -Winvalid-pch -Wfatal-errors")
   set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} ${WARNING_FLAGS}")
@@ -38,4 +38,47 @@ boost::property_tree::ptree ConfigManager::GetSubTree(const std::string& name) {
   return config_.get_child(name);
 }
 
-boost::property_tree::ptree ConfigManager::GetConfig() { return config_; }
\ No newline at end of file
+boost::property_tree::ptree ConfigManager::GetConfig() { return config_; }
+
+bool ConfigManager::ParseTowers(const std::string& file_path,
+                                std::string& error_message) {
+  towers_.Reset();
+  if (!boost::filesystem::exists(file_path)) {
+    error_message = file_path + ": File doesn't exist!";
+    return false;
+  }
+  try {
+    boost::property_tree::ptree full_tree;
+
+    boost::property_tree::json_parser::read_json(file_path, full_tree);
+
+    auto towers = full_tree.get_child_optional("towers");
+    if (!towers) {
+      error_message = file_path + ": No towers found";
+      return false;
+    }
+    if (!towers_.Load(*towers, error_message)) {
+      error_message = file_path + ": " + error_message;
+      return false;
+    }
+  } catch (boost::property_tree::json_parser::json_parser_error const& e) {
+    error_message = file_path + ": " + e.message();
+    return false;
+  }
+  return true;
+}
+
+bool ConfigManager::LoadTowers(const std::string& map_name,
+                               std::string& error_message) {
+  std::string file_path = "maps/" + map_name + "/towers.json";
+  if (!boost::filesystem::exists(file_path)) {
+    file_path = config_.get<std::string>("towers", "towers.json");
+  }
+  if (!boost::filesystem::exists(file_path)) {
+    towers_.Reset();
+    return true;
+  }
+  return ParseTowers(file_path, error_message);
+}
+
+const TowerTable& ConfigManager::GetTowers() const { return towers_; }
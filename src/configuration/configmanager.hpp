@@ -1,5 +1,7 @@
+#pragma once
 #include <boost/property_tree/ptree.hpp>
 #include <iostream>
+#include "../tower/tower_table.hpp"
 
 class ConfigManager {
  public:
@@ -33,8 +35,19 @@ class ConfigManager {
 
   boost::property_tree::ptree GetConfig();
 
+  // Reads the "towers" tree of a towers.json file into the tower table. The
+  // table is reset to the defaults first, and stays so if the file is
+  // invalid.
+  bool ParseTowers(const std::string& file_path, std::string& error_message);
+  // Reads maps/<map name>/towers.json or else the "towers" file of the
+  // settings. Without either file the defaults are used.
+  bool LoadTowers(const std::string& map_name, std::string& error_message);
+  // The stats the towers use, only change them while no simulation runs
+  const TowerTable& GetTowers() const;
+
  private:
   boost::property_tree::ptree config_;
+  TowerTable towers_;
 };
 
 #define config_manager ConfigManager::GetInstance()
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include "enemy_store.hpp"
+#include "../map/map.hpp"
+#include "../simulation/save_game.hpp"
+#include "movement.hpp"
+
+EnemyStore::EnemyStore() : next_id_(0) {}
+
+void EnemyStore::Reserve(int capacity) {
+  hp_.reserve(capacity);
+  max_hp_.reserve(capacity);
+  speed_.reserve(capacity);
+  x_.reserve(capacity);
+  y_.reserve(capacity);
+  target_tile_.reserve(capacity);
+  type_.reserve(capacity);
+  id_.reserve(capacity);
+  target_x_.reserve(capacity);
+  target_y_.reserve(capacity);
+  handles_.Reserve(capacity);
+}
+
+Handle EnemyStore::Add(const Enemy& enemy) {
+  hp_.push_back(enemy.GetMaxHp());
+  max_hp_.push_back(enemy.GetMaxHp());
+  speed_.push_back(enemy.GetSpeed());
+  x_.push_back(enemy.GetPosition().first);
+  y_.push_back(enemy.GetPosition().second);
+  target_tile_.push_back(-1);
+  type_.push_back(enemy.GetType());
+  id_.push_back(next_id_++);
+  target_x_.push_back(0);
+  target_y_.push_back(0);
+  return handles_.Add();
+}
+
+// Removes the enemy by moving the last enemy into its place
+void EnemyStore::Remove(int i) {
+  int last = Size() - 1;
+  hp_[i] = hp_[last];
+  max_hp_[i] = max_hp_[last];
+  speed_[i] = speed_[last];
+  x_[i] = x_[last];
+  y_[i] = y_[last];
+  target_tile_[i] = target_tile_[last];
+  type_[i] = type_[last];
+  id_[i] = id_[last];
+  hp_.pop_back();
+  max_hp_.pop_back();
+  speed_.pop_back();
+  x_.pop_back();
+  y_.pop_back();
+  target_tile_.pop_back();
+  type_.pop_back();
+  id_.pop_back();
+  target_x_.pop_back();
+  target_y_.pop_back();
+  handles_.Remove(i);
+}
+
+void EnemyStore::Clear() {
+  hp_.clear();
+  max_hp_.clear();
+  speed_.clear();
+  x_.clear();
+  y_.clear();
+  target_tile_.clear();
+  type_.clear();
+  id_.clear();
+  target_x_.clear();
+  target_y_.clear();
+  handles_.Clear();
+}
+
+int EnemyStore::Size() const { return hp_.size(); }
+bool EnemyStore::Empty() const { return hp_.empty(); }
+Handle EnemyStore::GetHandle(int i) const { return handles_.GetHandle(i); }
+int EnemyStore::GetIndex(const Handle& handle) const {
+  return handles_.GetIndex(handle);
+}
+
+void EnemyStore::Move(const Map& map) { Move(map, 0, Size()); }
+
+// Moves every living enemy towards the next tile of the map's flow field
+void EnemyStore::Move(const Map& map, int begin, int end) {
+  const std::vector<int>& flow_field = map.GetFlowField();
+  const int width = map.GetWidth();
+  for (int i = begin; i < end; i++) {
+    // Dead enemies aim at where they are, which keeps them in place
+    if (hp_[i] <= 0) {
+      target_x_[i] = x_[i];
+      target_y_[i] = y_[i];
+      continue;
+    }
+    int tile_x = x_[i];
+    int tile_y = y_[i];
+    int tile = tile_y * width + tile_x;
+    int& target = target_tile_[i];
+    if (target == -1) {
+      target = tile;
+    } else if (target == tile || map.GetDistance({target % width,
+                                                  target / width}) == -1) {
+      // Step on from the current tile, also when the map changed so that
+      // the tile walked to no longer leads to the base
+      if (flow_field[tile] != -1) {
+        target = flow_field[tile];
+      }
+    }
+    // Aim between the current and the next tile to round off corners
+    target_x_[i] = ((target % width + 0.5f) + (tile_x + 0.5f)) / 2;
+    target_y_[i] = ((target / width + 0.5f) + (tile_y + 0.5f)) / 2;
+  }
+  // Enemies move speed / 100 tiles per simulation step
+  Movement::Step(x_.data() + begin, y_.data() + begin,
+                 target_x_.data() + begin, target_y_.data() + begin,
+                 speed_.data() + begin, end - begin);
+}
+
+// The scratch space of Move isn't saved, it is refilled every step
+void EnemyStore::Save(SaveGame::Writer& writer) const {
+  // Every enemy has a value in each array and a slot in the handle pool
+  writer.Reserve(Size() * (6 * sizeof(float) + sizeof(int) + 1 +
+                           4 * sizeof(unsigned)) +
+                 1024);
+  writer.Write(next_id_);
+  writer.WriteVector(hp_);
+  writer.WriteVector(max_hp_);
+  writer.WriteVector(speed_);
+  writer.WriteVector(x_);
+  writer.WriteVector(y_);
+  writer.WriteVector(target_tile_);
+  writer.WriteVector(type_);
+  writer.WriteVector(id_);
+  handles_.Save(writer);
+}
+
+bool EnemyStore::Load(SaveGame::Reader& reader, const Map& map) {
+  EnemyStore store;
+  if (!reader.Read(store.next_id_) || !reader.ReadVector(store.hp_) ||
+      !reader.ReadVector(store.max_hp_) || !reader.ReadVector(store.speed_) ||
+      !reader.ReadVector(store.x_) || !reader.ReadVector(store.y_) ||
+      !reader.ReadVector(store.target_tile_) ||
+      !reader.ReadVector(store.type_) || !reader.ReadVector(store.id_) ||
+      !store.handles_.Load(reader)) {
+    return false;
+  }
+  const size_t size = store.hp_.size();
+  if (store.max_hp_.size() != size || store.speed_.size() != size ||
+      store.x_.size() != size || store.y_.size() != size ||
+      store.target_tile_.size() != size || store.type_.size() != size ||
+      store.id_.size() != size || size_t(store.handles_.Size()) != size) {
+    return false;
+  }
+  // Positions and tiles are used as indices into the map
+  const int width = map.GetWidth();
+  const int height = map.GetHeight();
+  for (size_t i = 0; i < size; i++) {
+    if (!(store.x_[i] >= 0 && store.x_[i] < width) ||
+        !(store.y_[i] >= 0 && store.y_[i] < height) ||
+        store.target_tile_[i] < -1 ||
+        store.target_tile_[i] >= width * height || store.type_[i] > Boss) {
+      return false;
+    }
+  }
+  store.target_x_.resize(size);
+  store.target_y_.resize(size);
+  *this = std::move(store);
+  return true;
+}
+
+float EnemyStore::GetHp(int i) const { return hp_[i]; }
+void EnemyStore::SetHp(int i, float hp) { hp_[i] = hp; }
+bool EnemyStore::IsAlive(int i) const { return hp_[i] > 0; }
+float EnemyStore::GetMaxHp(int i) const { return max_hp_[i]; }
+float EnemyStore::GetSpeed(int i) const { return speed_[i]; }
+const std::pair<float, float> EnemyStore::GetPosition(int i) const {
+  return {x_[i], y_[i]};
+}
+const std::pair<int, int> EnemyStore::GetTile(int i) const {
+  return {int(x_[i]), int(y_[i])};
+}
+EnemyTypes EnemyStore::GetType(int i) const { return EnemyTypes(type_[i]); }
+unsigned EnemyStore::GetId(int i) const { return id_[i]; }
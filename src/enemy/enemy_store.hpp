@@ -0,0 +1,60 @@
+#pragma once
+#include <vector>
+#include "../simulation/handle_pool.hpp"
+#include "enemy.hpp"
+
+class Map;
+
+// The enemies on the field, stored as one array per attribute so that the
+// per step loops over movement and targeting only touch the data they need.
+// Enemies are addressed by their index, which changes when another enemy is
+// removed. A handle keeps referring to the same enemy until it is removed.
+class EnemyStore {
+ public:
+  EnemyStore();
+  // Allocates room for capacity enemies up front, the store never shrinks
+  void Reserve(int capacity);
+  Handle Add(const Enemy& enemy);
+  void Remove(int i);
+  void Clear();
+  int Size() const;
+  bool Empty() const;
+  Handle GetHandle(int i) const;
+  // Returns the index of the enemy or -1 if it has been removed
+  int GetIndex(const Handle& handle) const;
+  void Move(const Map& map);
+  // Moves only the enemies in [begin, end), disjoint ranges can be moved by
+  // different threads at the same time
+  void Move(const Map& map, int begin, int end);
+  void Save(SaveGame::Writer& writer) const;
+  // Returns false and leaves the store unchanged if the data is invalid or
+  // doesn't fit on the map
+  bool Load(SaveGame::Reader& reader, const Map& map);
+
+  float GetHp(int i) const;
+  void SetHp(int i, float hp);
+  bool IsAlive(int i) const;
+  float GetMaxHp(int i) const;
+  float GetSpeed(int i) const;
+  const std::pair<float, float> GetPosition(int i) const;
+  const std::pair<int, int> GetTile(int i) const;
+  EnemyTypes GetType(int i) const;
+  unsigned GetId(int i) const;
+
+ private:
+  std::vector<float> hp_;
+  std::vector<float> max_hp_;
+  std::vector<float> speed_;
+  std::vector<float> x_;
+  std::vector<float> y_;
+  // Index of the tile the enemy is walking to, -1 before the first move
+  std::vector<int> target_tile_;
+  std::vector<unsigned char> type_;
+  // Spawn order of the enemy, stays the same when enemies are removed
+  std::vector<unsigned> id_;
+  unsigned next_id_;
+  HandlePool handles_;
+  // Scratch space for the point each enemy moves towards in this step
+  std::vector<float> target_x_;
+  std::vector<float> target_y_;
+};
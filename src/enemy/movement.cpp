@@ -0,0 +1,103 @@
+#include "movement.hpp"
+#include <math.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#if defined(__AVX__)
+#include <immintrin.h>
+#define MOVEMENT_AVX
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define MOVEMENT_SSE
+#endif
+#endif
+
+namespace Movement {
+
+void StepScalar(float* x, float* y, const float* target_x,
+                const float* target_y, const float* speed, int count) {
+  for (int i = 0; i < count; i++) {
+    float dx = target_x[i] - x[i];
+    float dy = target_y[i] - y[i];
+    float dist = sqrtf(dx * dx + dy * dy);
+    if (dist != 0) {
+      dx /= dist;
+      dy /= dist;
+    }
+    x[i] += dx * speed[i] / 100;
+    y[i] += dy * speed[i] / 100;
+  }
+}
+
+#if defined(MOVEMENT_AVX)
+
+void Step(float* x, float* y, const float* target_x, const float* target_y,
+          const float* speed, int count) {
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 hundred = _mm256_set1_ps(100);
+  int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 px = _mm256_loadu_ps(x + i);
+    __m256 py = _mm256_loadu_ps(y + i);
+    __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(target_x + i), px);
+    __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(target_y + i), py);
+    __m256 dist = _mm256_sqrt_ps(
+        _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+    // Only normalize where the distance isn't zero
+    __m256 moving = _mm256_cmp_ps(dist, zero, _CMP_NEQ_UQ);
+    dx = _mm256_blendv_ps(dx, _mm256_div_ps(dx, dist), moving);
+    dy = _mm256_blendv_ps(dy, _mm256_div_ps(dy, dist), moving);
+    __m256 s = _mm256_loadu_ps(speed + i);
+    px = _mm256_add_ps(px, _mm256_div_ps(_mm256_mul_ps(dx, s), hundred));
+    py = _mm256_add_ps(py, _mm256_div_ps(_mm256_mul_ps(dy, s), hundred));
+    _mm256_storeu_ps(x + i, px);
+    _mm256_storeu_ps(y + i, py);
+  }
+  StepScalar(x + i, y + i, target_x + i, target_y + i, speed + i, count - i);
+}
+
+const char* GetInstructionSet() { return "avx"; }
+
+#elif defined(MOVEMENT_SSE)
+
+void Step(float* x, float* y, const float* target_x, const float* target_y,
+          const float* speed, int count) {
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 hundred = _mm_set1_ps(100);
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 px = _mm_loadu_ps(x + i);
+    __m128 py = _mm_loadu_ps(y + i);
+    __m128 dx = _mm_sub_ps(_mm_loadu_ps(target_x + i), px);
+    __m128 dy = _mm_sub_ps(_mm_loadu_ps(target_y + i), py);
+    __m128 dist =
+        _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+    // Only normalize where the distance isn't zero, SSE2 has no blend so
+    // select with and/andnot
+    __m128 moving = _mm_cmpneq_ps(dist, zero);
+    dx = _mm_or_ps(_mm_and_ps(moving, _mm_div_ps(dx, dist)),
+                   _mm_andnot_ps(moving, dx));
+    dy = _mm_or_ps(_mm_and_ps(moving, _mm_div_ps(dy, dist)),
+                   _mm_andnot_ps(moving, dy));
+    __m128 s = _mm_loadu_ps(speed + i);
+    px = _mm_add_ps(px, _mm_div_ps(_mm_mul_ps(dx, s), hundred));
+    py = _mm_add_ps(py, _mm_div_ps(_mm_mul_ps(dy, s), hundred));
+    _mm_storeu_ps(x + i, px);
+    _mm_storeu_ps(y + i, py);
+  }
+  StepScalar(x + i, y + i, target_x + i, target_y + i, speed + i, count - i);
+}
+
+const char* GetInstructionSet() { return "sse2"; }
+
+#else
+
+void Step(float* x, float* y, const float* target_x, const float* target_y,
+          const float* speed, int count) {
+  StepScalar(x, y, target_x, target_y, speed, count);
+}
+
+const char* GetInstructionSet() { return "scalar"; }
+
+#endif
+
+}  // namespace Movement
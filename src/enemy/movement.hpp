@@ -0,0 +1,18 @@
+#pragma once
+
+// Batch movement of enemies. Every enemy i is moved speed[i] / 100 tiles
+// towards (target_x[i], target_y[i]). All variants give bit identical results,
+// because they only use float operations that IEEE 754 rounds exactly.
+namespace Movement {
+// Plain loop, the reference implementation
+void StepScalar(float* x, float* y, const float* target_x,
+                const float* target_y, const float* speed, int count);
+
+// Vectorized with the widest instruction set the build allows and finishes
+// the remainder with the scalar loop
+void Step(float* x, float* y, const float* target_x, const float* target_y,
+          const float* speed, int count);
+
+// Name of the instruction set Step uses
+const char* GetInstructionSet();
+}  // namespace Movement
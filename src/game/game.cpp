@@ -1,7 +1,8 @@
 #include "game.hpp"
 #include "../configuration/configmanager.hpp"
+#include "../profiler/profiler.hpp"
 
-Game::Game() {
+Game::Game() : time_scale_(1) {
   window.create(sf::VideoMode(1280, 720), "Tower Defence");
   window.setFramerateLimit(60);
 
@@ -38,9 +39,29 @@ void Game::Run() {
   music.play();
   while (window.isOpen()) {
     if (PeekState() == nullptr) continue;
-    PeekState()->HandleInput();
-    window.clear();
-    PeekState()->Draw();
-    window.display();
+    {
+      PROFILE_SCOPE(Frame, "Frame");
+      {
+        PROFILE_SCOPE(Frame, "HandleInput");
+        PeekState()->HandleInput();
+      }
+      {
+        PROFILE_SCOPE(Frame, "Update");
+        PeekState()->Update();
+      }
+      {
+        PROFILE_SCOPE(Frame, "Draw");
+        window.clear();
+        PeekState()->Draw();
+      }
+      // Includes waiting for the frame rate limit
+      PROFILE_SCOPE(Frame, "Display");
+      window.display();
+    }
+    profiler.EndFrame(Profiler::Frame);
   }
 }
+
+float Game::GetTimeScale() const { return time_scale_; }
+
+void Game::SetTimeScale(float time_scale) { time_scale_ = time_scale; }
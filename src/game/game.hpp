@@ -15,6 +15,8 @@ class Game {
   void ChangeState(GameState* state);
   GameState* PeekState();
   void Run();
+  float GetTimeScale() const;
+  void SetTimeScale(float time_scale);
   float GetMusicVolume() const;
   void SetMusicVolume(float volume);
   sf::RenderWindow window;
@@ -22,4 +24,5 @@ class Game {
 
  private:
   std::stack<GameState*> states_;
+  float time_scale_;
 };
\ No newline at end of file
@@ -8,4 +8,6 @@ class GameState {
   Game* game;
   virtual void Draw() = 0;
   virtual void HandleInput() = 0;
+  // Called once per frame before drawing
+  virtual void Update() {}
 };
@@ -1,4 +1,5 @@
 #include "map_state.hpp"
+#include <boost/filesystem.hpp>
 #include <iostream>
 #include "../configuration/configmanager.hpp"
 #include "../map/map.hpp"
@@ -191,14 +192,23 @@ void MapState::InitGUI() {
 }
 
 void MapState::LoadGame() {
-  map_.Load(config_manager->GetValueOrDefault<std::string>(
-      "maps/" + map_.GetName() + "/file", "maps/01/file"));
-  map_.tile_size =
-      std::min((this->game->window.getSize().x - 200) / map_.GetWidth(),
-               (this->game->window.getSize().y - 200) / map_.GetHeight());
-  wave_manager.ParseFile(
+  // A precompiled bundle of the map and its waves loads without parsing
+  std::string bundle =
       "maps/" + map_.GetName() + "/" +
       config_manager->GetValueOrDefault<std::string>(
-          "maps/" + map_.GetName() + "/waves", "maps/01/waves"));
+          "maps/" + map_.GetName() + "/bundle", "map.bundle");
+  if (!boost::filesystem::exists(bundle) || !map_.LoadBundle(bundle)) {
+    map_.Load(config_manager->GetValueOrDefault<std::string>(
+        "maps/" + map_.GetName() + "/file", "maps/01/file"));
+    wave_manager.ParseFile(
+        "maps/" + map_.GetName() + "/" +
+        config_manager->GetValueOrDefault<std::string>(
+            "maps/" + map_.GetName() + "/waves", "maps/01/waves"));
+  }
+  // The map's towers.json or the global one, the defaults if it's invalid
+  std::string towers_error;
+  if (!config_manager->LoadTowers(map_.GetName(), towers_error)) {
+    std::cout << towers_error << std::endl;
+  }
   this->game->PushState(new PlayState(this->game, map_));
 }
@@ -1,100 +1,234 @@
 #include "play_state.hpp"
 #include <math.h>
 #include <SFML/Graphics.hpp>
+#include <algorithm>
 #include <boost/format.hpp>
-#include <boost/range/adaptor/reversed.hpp>
 #include <chrono>
 #include <iostream>
+#include <limits>
 #include <thread>
 #include <vector>
 #include "../configuration/configmanager.hpp"
 #include "../enemy/enemy.hpp"
-#include "../tower/basic_tower.hpp"
-#include "../tower/money_tower.hpp"
-#include "../tower/ship_tower.hpp"
+#include "../profiler/profiler.hpp"
+#include "../tower/tower_types.hpp"
 #include "game_state.hpp"
 #include "menu_state.hpp"
+#include "texture_atlas.hpp"
 #include "texturemanager.hpp"
 
 PlayState::PlayState(Game* game, Map map)
-    : selected_tower_(nullptr),
-      last_spawn_(0),
-      wave_(1),
-      money_per_wave_(50),
-      player_(Player("Pelle", 3, 500)) {
+    : runner_(map, Player("Pelle", 3, 500), config_manager->GetTowers()),
+      tile_size_(0),
+      enemy_vertices_(sf::Quads),
+      hp_bar_vertices_(sf::Quads),
+      tower_vertices_(sf::Quads),
+      selected_level_(0),
+      show_profiler_(false),
+      profiler_vertices_(sf::Quads) {
   this->game = game;
-  map_ = map;
+  runner_.SetJobSystem(&jobs_);
+  // Record the game, so that it can be replayed with td-replay
+  std::string replay =
+      config_manager->GetValueOrDefault<std::string>("replay", "");
+  if (!replay.empty()) {
+    runner_.StartRecording(replay, map.GetName());
+  }
+  runner_.Start();
   sf::Vector2f window_size = sf::Vector2f(this->game->window.getSize());
   sf::View view_(sf::FloatRect(0, 0, window_size.x, window_size.y));
   this->game->window.setView(view_);
   if (!font_.loadFromFile("sprites/Arial.ttf")) {
     std::cout << "Failed to load font";
   }
+  if (!texture_atlas.IsLoaded()) {
+    texture_atlas.Load("sprites");
+  }
   background_.setTexture(
       texture_manager.GetTexture("sprites/gui_background.png"));
   background_.setScale(float(this->game->window.getSize().x) /
                            float(background_.getTexture()->getSize().x),
                        float(this->game->window.getSize().y) /
                            float(background_.getTexture()->getSize().y));
+  UpdateMapLayer();
   InitGUI();
 }
 
 void PlayState::Draw() {
+  const Snapshot& snapshot = runner_.GetSnapshot();
+  PROFILE_COUNT(Frame, "Enemies", snapshot.x.size());
+  PROFILE_COUNT(Frame, "Towers", snapshot.towers.size());
   this->game->window.draw(background_);
-  map_.Draw(this->game->window);
-
-  // Get enemies remaining if there are any
-  int enemies = std::count_if(enemies_.begin(), enemies_.end(),
-                              [](Enemy e) { return e.IsAlive(); });
-  gui_.at("sidegui").Get("wave").SetTitle(
-      "Wave: " + std::to_string(wave_ - 1) +
-      "\nEnemies: " + std::to_string(spawn_queue_.size() + enemies));
-
-  // Check if we should enable the next wave button
-  if (enemies_.size() == 0 && spawn_queue_.size() == 0 &&
-      !gui_.at("sidegui").Get("nextwave").IsEnabled()) {
-    gui_.at("sidegui").Get("nextwave").Enable();
-    player_.AddMoney(money_per_wave_);
-    money_per_wave_ += 50;
+  PROFILE_COUNT(Frame, "Draw calls", 1);
+  DrawMap();
+
+  {
+    PROFILE_SCOPE(Frame, "GUI");
+    gui_.at("sidegui").Get("wave").SetTitle(GetWaveStats(snapshot));
+
+    // Check if we should enable the next wave button
+    if (!snapshot.wave_active &&
+        !gui_.at("sidegui").Get("nextwave").IsEnabled()) {
+      gui_.at("sidegui").Get("nextwave").Enable();
+    }
+
+    if (selected_tower_) {
+      // Upgrades show once the simulation published them
+      const Snapshot::TowerState* tower = FindTower(snapshot, *selected_tower_);
+      if (tower && tower->level != selected_level_) UpdateTowerStats(*tower);
+      this->game->window.draw(gui_.at("towergui"));
+    }
   }
 
-  if (selected_tower_) this->game->window.draw(gui_.at("towergui"));
+  DrawEnemies(snapshot);
+  DrawTowers(snapshot);
+  {
+    PROFILE_SCOPE(Frame, "GUI");
+    if (snapshot.game_over && !gui_.at("sidegui").Has("gameover")) {
+      ShowGameOver();
+    }
+    UpdatePlayerStats(snapshot);
+    this->game->window.draw(gui_.at("sidegui"));
+  }
+  if (show_profiler_) DrawProfiler();
+}
+
+void PlayState::Update() { runner_.SetTimeScale(this->game->GetTimeScale()); }
+
+void PlayState::DrawMap() {
+  PROFILE_SCOPE(Frame, "DrawMap");
+  this->game->window.draw(map_sprite_);
+  PROFILE_COUNT(Frame, "Draw calls", 1);
+}
 
-  for (auto& enemy : boost::adaptors::reverse(enemies_)) {
-    if (enemy.IsAlive()) {
-      enemy.SetPosition(
-          enemy.GetPosition().first * GetTileSize() - GetTileSize() / 2,
-          enemy.GetPosition().second * GetTileSize() - GetTileSize() / 2);
-      enemy.SetScale(GetTileSize() / (float)(enemy.GetTexture()).getSize().x,
-                     GetTileSize() / (float)(enemy.GetTexture()).getSize().y);
-      this->game->window.draw(enemy);
+// Recalculates the tile size from the window size and redraws the map layer
+void PlayState::UpdateMapLayer() {
+  const Map& map = runner_.GetMap();
+  auto windowsize = this->game->window.getSize();
+  int tile_size_x = (windowsize.x - 200) / map.GetWidth();
+  int tile_size_y = (windowsize.y - 200) / map.GetHeight();
+  tile_size_ = std::max(1, std::min(tile_size_x, tile_size_y));
+
+  float tile_size = tile_size_;
+  sf::VertexArray vertices(sf::Quads);
+  for (int y = 0; y < map.GetHeight(); y++) {
+    for (int x = 0; x < map.GetWidth(); x++) {
+      texture_atlas.AppendSprite(
+          vertices, GetTileTextureName(map(x, y)),
+          sf::FloatRect(x * tile_size, y * tile_size, tile_size, tile_size));
     }
   }
-  for (auto& tower : towers_) {
-    tower.second->SetPosition(
-        tower.second->GetPosition().first * GetTileSize(),
-        tower.second->GetPosition().second * GetTileSize());
-    tower.second->SetScale(
-        GetTileSize() / (float)(tower.second->GetTexture()).getSize().x,
-        GetTileSize() / (float)(tower.second->GetTexture()).getSize().y);
-    this->game->window.draw(*tower.second);
+  if (!map_layer_.create(tile_size_ * map.GetWidth(),
+                         tile_size_ * map.GetHeight())) {
+    std::cout << "Failed to create the map layer" << std::endl;
+    return;
+  }
+  map_layer_.clear(sf::Color::Transparent);
+  map_layer_.draw(vertices, &texture_atlas.GetTexture());
+  PROFILE_COUNT(Frame, "Draw calls", 1);
+  map_layer_.display();
+  map_sprite_.setTexture(map_layer_.getTexture(), true);
+}
+
+// Draws the enemies between their positions in the last two snapshots, by how
+// far the time since the last one is into the next step
+void PlayState::DrawEnemies(const Snapshot& snapshot) {
+  PROFILE_SCOPE(Frame, "DrawEnemies");
+  float elapsed = std::chrono::duration<float>(
+                      std::chrono::steady_clock::now() - snapshot.time)
+                      .count();
+  float t = snapshot.interval > 0
+                ? std::min(1.f, elapsed / snapshot.interval)
+                : 1.f;
+  float tile_size = GetTileSize();
+  enemy_vertices_.clear();
+  hp_bar_vertices_.clear();
+  for (int i = int(snapshot.x.size()) - 1; i >= 0; i--) {
+    float x = snapshot.previous_x[i] +
+              (snapshot.x[i] - snapshot.previous_x[i]) * t;
+    float y = snapshot.previous_y[i] +
+              (snapshot.y[i] - snapshot.previous_y[i]) * t;
+    sf::Vector2f position(x * tile_size - tile_size / 2,
+                          y * tile_size - tile_size / 2);
+    texture_atlas.AppendSprite(
+        enemy_vertices_, GetEnemyTextureName(snapshot.type[i]),
+        sf::FloatRect(position.x, position.y, tile_size, tile_size));
+
+    // The hp bar is half a tile wide and centered above the enemy
+    float hp_ratio = snapshot.hp[i] / snapshot.max_hp[i];
+    sf::FloatRect hp_bar(position.x + tile_size / 4, position.y,
+                         tile_size / 2, tile_size / 10);
+    texture_atlas.AppendRect(hp_bar_vertices_, hp_bar, sf::Color::Red);
+    hp_bar.width *= hp_ratio;
+    texture_atlas.AppendRect(hp_bar_vertices_, hp_bar, sf::Color::Green);
+  }
+  this->game->window.draw(enemy_vertices_, &texture_atlas.GetTexture());
+  this->game->window.draw(hp_bar_vertices_, &texture_atlas.GetTexture());
+  PROFILE_COUNT(Frame, "Draw calls", 2);
+}
+
+void PlayState::DrawTowers(const Snapshot& snapshot) {
+  PROFILE_SCOPE(Frame, "DrawTowers");
+  float tile_size = GetTileSize();
+  tower_vertices_.clear();
+  for (auto& tower : snapshot.towers) {
+    sf::Vector2f position(tower.position.first * tile_size,
+                          tower.position.second * tile_size);
+    if (selected_tower_ && tower.position == *selected_tower_) {
+      DrawRange(
+          runner_.GetTowerTable().GetLevel(tower.type, tower.level).range,
+          position);
+      DrawTarget(snapshot, tower.position, position);
+    }
+    texture_atlas.AppendSprite(
+        tower_vertices_, GetTowerTextureName(tower.type),
+        sf::FloatRect(position.x, position.y, tile_size, tile_size));
   }
 
   // If we have an active tower, draw it on the mouse position
   if (active_tower_.get_ptr() != 0) {
-    active_tower_->second->SetPosition(
+    sf::Vector2f position(
         sf::Mouse::getPosition(this->game->window).x - GetTileSize() / 2,
         sf::Mouse::getPosition(this->game->window).y - GetTileSize() / 2);
-    active_tower_->second->SetScale(
-        GetTileSize() /
-            (float)(active_tower_->second->GetTexture()).getSize().x,
-        GetTileSize() /
-            (float)(active_tower_->second->GetTexture()).getSize().y);
-    this->game->window.draw(*active_tower_.get().second);
+    DrawRange(runner_.GetTowerTable().GetLevel(*active_tower_, 1).range,
+              position);
+    texture_atlas.AppendSprite(
+        tower_vertices_, GetTowerTextureName(*active_tower_),
+        sf::FloatRect(position.x, position.y, tile_size, tile_size));
   }
-  UpdatePlayerStats();
-  this->game->window.draw(gui_.at("sidegui"));
-  Tick();
+  this->game->window.draw(tower_vertices_, &texture_atlas.GetTexture());
+  PROFILE_COUNT(Frame, "Draw calls", 1);
+}
+
+// Draws a circle of the range in tiles around the tile at position
+void PlayState::DrawRange(float range, sf::Vector2f position) {
+  int tile_size = GetTileSize();
+  float radius = tile_size * range;
+  sf::CircleShape circle(radius);
+  circle.setFillColor(sf::Color(255, 255, 255, 100));
+  circle.setPosition(position + sf::Vector2f(-radius + tile_size / 2,
+                                             -radius + tile_size / 2));
+  this->game->window.draw(circle);
+  PROFILE_COUNT(Frame, "Draw calls", 1);
+}
+
+// Draws a line to the enemy the tower attacked last while it is alive
+void PlayState::DrawTarget(const Snapshot& snapshot,
+                           const std::pair<int, int>& tower,
+                           sf::Vector2f position) {
+  auto target = std::find_if(snapshot.targets.begin(), snapshot.targets.end(),
+                             [&tower](const Snapshot::Target& target) {
+                               return target.tower == tower;
+                             });
+  if (target == snapshot.targets.end()) return;
+  float tile_size = GetTileSize();
+  sf::Vertex line[] = {
+      sf::Vertex(position + sf::Vector2f(tile_size / 2, tile_size / 2),
+                 sf::Color::Red),
+      sf::Vertex(sf::Vector2f(target->x * tile_size, target->y * tile_size),
+                 sf::Color::Red)};
+  this->game->window.draw(line, 2, sf::Lines);
+  PROFILE_COUNT(Frame, "Draw calls", 1);
 }
 
 void PlayState::HandleInput() {
@@ -111,74 +245,19 @@ void PlayState::HandleInput() {
       case sf::Event::Resized: {
         view_.reset(sf::FloatRect(0, 0, event.size.width, event.size.height));
         this->game->window.setView(view_);
-        const int margin = 10;
-        const int top_margin = 20;
-        int map_size = GetTileSize() * map_.GetWidth();
-        gui_.at("sidegui").Get("tower1").SetPosition(sf::Vector2f(map_size, 0));
-
-        int tower_height = gui_.at("sidegui").Get("tower1").GetHeight();
-        int tower_width = gui_.at("sidegui").Get("tower1").GetWidth();
-
-        gui_.at("sidegui")
-            .Get("tower1_info")
-            .SetPosition(sf::Vector2f(map_size + tower_width,
-                                      tower_width / 2 - top_margin));
-
-        gui_.at("sidegui").Get("tower2").SetPosition(
-            sf::Vector2f(map_size, tower_height + margin));
-
-        tower_width = gui_.at("sidegui").Get("tower2").GetWidth();
-
-        gui_.at("sidegui")
-            .Get("tower2_info")
-            .SetPosition(sf::Vector2f(
-                map_size + tower_width,
-                tower_height + margin + tower_width / 2 - top_margin));
-
-        tower_height += gui_.at("sidegui").Get("tower2").GetHeight();
-
-        gui_.at("sidegui").Get("tower3").SetPosition(
-            sf::Vector2f(map_size, tower_height + margin));
-
-        tower_width = gui_.at("sidegui").Get("tower3").GetWidth();
-
-        gui_.at("sidegui")
-            .Get("tower3_info")
-            .SetPosition(sf::Vector2f(
-                map_size + tower_width,
-                tower_height + margin + tower_width / 2 - top_margin));
-
-        tower_height += gui_.at("sidegui").Get("tower3").GetHeight();
-        gui_.at("sidegui").Get("wave").SetPosition(
-            sf::Vector2f(map_size + margin, tower_height + margin));
-
-        int wave_height = gui_.at("sidegui").Get("wave").GetHeight();
-        gui_.at("sidegui").Get("player").SetPosition(sf::Vector2f(
-            map_size + margin, tower_height + wave_height + 2 * margin));
-
-        int player_height = gui_.at("sidegui").Get("player").GetHeight();
-        gui_.at("sidegui")
-            .Get("nextwave")
-            .SetPosition(sf::Vector2f(
-                map_size,
-                tower_height + wave_height + player_height + 4 * margin));
-
-        int nextwave_height = gui_.at("sidegui").Get("nextwave").GetHeight();
-        gui_.at("sidegui")
-            .Get("cancelbuy")
-            .SetPosition(sf::Vector2f(
-                map_size, tower_height + wave_height + player_height +
-                              nextwave_height + 4 * margin));
+        UpdateMapLayer();
+        PositionSideGui();
         background_.setScale(float(this->game->window.getSize().x) /
                                  float(background_.getTexture()->getSize().x),
                              float(this->game->window.getSize().y) /
                                  float(background_.getTexture()->getSize().y));
-        int map_size_y = GetTileSize() * map_.GetHeight();
+        const int margin = 10;
+        int map_size_y = GetTileSize() * runner_.GetMap().GetHeight();
         if (gui_.find("towergui") != gui_.end()) {
           gui_.at("towergui")
               .Get("tower")
               .SetPosition(sf::Vector2f(0, map_size_y));
-          tower_width = gui_.at("towergui").Get("tower").GetWidth();
+          int tower_width = gui_.at("towergui").Get("tower").GetWidth();
 
           gui_.at("towergui")
               .Get("tower_stats")
@@ -207,12 +286,13 @@ void PlayState::HandleInput() {
         sf::Vector2f mouse_position =
             sf::Vector2f(event.mouseButton.x, event.mouseButton.y);
         if (event.mouseButton.button == sf::Mouse::Left) {
-          if (player_.GetLives() > 0) {
+          if (!runner_.GetSnapshot().game_over) {
             int tile_size = GetTileSize();
             int tile_x = mouse_position.x / tile_size;
             int tile_y = mouse_position.y / tile_size;
-            if (tile_x >= 0 && tile_y >= 0 && tile_x < map_.GetWidth() &&
-                tile_y < map_.GetHeight()) {
+            if (tile_x >= 0 && tile_y >= 0 &&
+                tile_x < runner_.GetMap().GetWidth() &&
+                tile_y < runner_.GetMap().GetHeight()) {
               HandleMapClick(tile_x, tile_y);
             } else {
               HandleGuiClick(mouse_position);
@@ -246,6 +326,33 @@ void PlayState::HandleInput() {
             if (vol - 5 >= 0) vol -= 5;
             game->music.setVolume(vol);
             break;
+          // Game speed
+          case sf::Keyboard::Num1:
+            game->SetTimeScale(1);
+            break;
+          case sf::Keyboard::Num2:
+            game->SetTimeScale(2);
+            break;
+          case sf::Keyboard::Num3:
+            game->SetTimeScale(10);
+            break;
+          case sf::Keyboard::Num4:
+            game->SetTimeScale(std::numeric_limits<float>::infinity());
+            break;
+          // Profiler overlay and trace
+          case sf::Keyboard::F3:
+            show_profiler_ = !show_profiler_;
+            profiler.SetEnabled(show_profiler_);
+            break;
+          case sf::Keyboard::F4:
+            WriteTrace();
+            break;
+          case sf::Keyboard::F5:
+            QuickSave();
+            break;
+          case sf::Keyboard::F9:
+            QuickLoad();
+            break;
           default:
             break;
         }
@@ -257,402 +364,276 @@ void PlayState::HandleInput() {
   }
 }
 
-void PlayState::Tick() {
-  auto path = map_.GetPath();
-  auto player_base = map_.GetPlayerBase();
-  std::vector<Enemy>::iterator it = enemies_.begin();
-
-  // Loop through all enemies and move them if they aren't dead
-  while (it != enemies_.end()) {
-    if (it->IsAlive()) {
-      it->Move(path);
-      if (it->GetTile() == player_base) {
-        it->SetHp(0);
-        bool dead = player_.GetLives() == 0;
-        if (player_.GetLives() > 0) {
-          player_.RemoveLives(1);
-          UpdatePlayerStats();
-        }
-        if (player_.GetLives() == 0 && !dead) {
-          std::cout << "YOU LOST NOOB" << std::endl;
-          gui_.at("sidegui").Add(
-              "gameover",
-              GuiEntry(sf::Vector2f(this->game->window.getSize().x / 2,
-                                    this->game->window.getSize().y / 2),
-                       std::string("Game over!"),
-                       texture_manager.GetTexture("sprites/button.png"),
-                       font_));
-          gui_.at("sidegui")
-              .Get("gameover")
-              .SetPosition(
-                  gui_.at("sidegui").Get("gameover").GetPosition() +
-                  sf::Vector2f(
-                      -gui_.at("sidegui").Get("gameover").GetWidth() / 2,
-                      -gui_.at("sidegui").Get("gameover").GetHeight() / 2));
-          // game->window.close();
-        }
-      }
-      it++;
-    } else {
-      it = enemies_.erase(it);
+// Lists the sections of the profiler with their last, average and highest
+// value over the history, next to bars of the history itself
+void PlayState::DrawProfiler() {
+  const float line_height = 15;
+  const float padding = 5;
+  const float column_width = 70;
+  const float name_width = 150;
+  auto sections = profiler.GetSections();
+  float history_x = padding + name_width + 3 * column_width;
+  float width = history_x + Profiler::HISTORY_SIZE + padding;
+  float height = (sections.size() + 1) * line_height + 2 * padding;
+  profiler_vertices_.clear();
+  texture_atlas.AppendRect(profiler_vertices_,
+                           sf::FloatRect(0, 0, width, height),
+                           sf::Color(0, 0, 0, 200));
+
+  // Timers are shown in milliseconds
+  std::string columns[4] = {"Section", "Last", "Average", "Max"};
+  for (size_t i = 0; i < sections.size(); i++) {
+    const Profiler::Section& section = sections[i];
+    float scale = section.counter ? 1 : 0.001;
+    float last = section.history[(section.next + Profiler::HISTORY_SIZE - 1) %
+                                 Profiler::HISTORY_SIZE];
+    float sum = 0, max = 0;
+    for (float value : section.history) {
+      sum += value;
+      max = std::max(max, value);
     }
-  }
-
-  FindEnemies();
-  auto cur_time = clock_.getElapsedTime().asSeconds();
-  // Add enemies to the enemies vector with a certain delay
-  if (spawn_queue_.size() > 0) {
-    float delay = spawn_queue_.front().GetDelay();
-    if (cur_time - last_spawn_ > delay && spawn_queue_.size() > 0) {
-      enemies_.push_back(spawn_queue_.front());
-      spawn_queue_.pop_front();
-      last_spawn_ = cur_time;
+    const char* format = section.counter ? "%.0f" : "%.2f";
+    columns[0] += std::string("\n") +
+                  (section.track == Profiler::Frame ? "Frame " : "Tick ") +
+                  section.name;
+    columns[1] += "\n" + boost::str(boost::format(format) % (last * scale));
+    columns[2] += "\n" + boost::str(boost::format(format) %
+                                    (sum / Profiler::HISTORY_SIZE * scale));
+    columns[3] += "\n" + boost::str(boost::format(format) % (max * scale));
+
+    // The oldest value first, scaled to the highest one
+    sf::Color color = section.counter ? sf::Color::Blue
+                      : section.track == Profiler::Frame ? sf::Color::Green
+                                                          : sf::Color::Yellow;
+    float bottom = padding + (i + 2) * line_height - 2;
+    for (int j = 0; j < Profiler::HISTORY_SIZE && max > 0; j++) {
+      float value = section.history[(section.next + j) %
+                                    Profiler::HISTORY_SIZE];
+      float bar = value / max * (line_height - 3);
+      texture_atlas.AppendRect(
+          profiler_vertices_,
+          sf::FloatRect(history_x + j, bottom - bar, 1, bar), color);
     }
   }
+  this->game->window.draw(profiler_vertices_, &texture_atlas.GetTexture());
+
+  float x = padding;
+  for (int i = 0; i < 4; i++) {
+    sf::Text text(columns[i], font_, 12);
+    text.setFillColor(sf::Color::White);
+    text.setPosition(x, padding);
+    this->game->window.draw(text);
+    x += i == 0 ? name_width : column_width;
+  }
 }
 
-void PlayState::AddToSpawnQueue(std::vector<Enemy> enemies) {
-  for (auto& enemy : enemies) {
-    spawn_queue_.push_back(enemy);
+void PlayState::WriteTrace() {
+  std::string file_path =
+      config_manager->GetValueOrDefault<std::string>("trace", "");
+  if (file_path.empty()) return;
+  if (profiler.WriteTrace(file_path)) {
+    std::cout << "Wrote the profiler trace to " << file_path << std::endl;
   }
 }
 
-void PlayState::FindEnemies() {
-  auto cur_time = clock_.getElapsedTime().asSeconds();
-  float longest_distance = std::numeric_limits<float>::max();
-  Enemy* closest_enemy = nullptr;
-  auto path = map_.GetPath();
-  for (auto& tower : towers_) {
-    closest_enemy = nullptr;
-    longest_distance = std::numeric_limits<float>::min();
-    float range = tower.second->GetRange();
-    auto tower_pos = tower.second->GetPosition();
-
-    for (auto& enemy : enemies_) {
-      auto enemy_pos = enemy.GetPosition();
-      float distance = sqrt(pow(tower_pos.first + 0.5 - enemy_pos.first, 2) +
-                            pow(tower_pos.second + 0.5 - enemy_pos.second, 2));
-      auto path_it = std::find(path.begin(), path.end(), enemy.GetTile());
-      int idx = std::distance(path.begin(), path_it);
-      if (distance <= range && idx > longest_distance && enemy.IsAlive()) {
-        closest_enemy = &enemy;
-        longest_distance = idx;
-      }
-    }
-    if ((closest_enemy) && (cur_time - tower.second->GetLastAttack() >
-                            (1 / tower.second->GetAttSpeed()))) {
-      tower.second->SetLastAttack(cur_time);
-      bool dead = tower.second->Attack(*closest_enemy);
-      if (dead) {
-        switch (closest_enemy->GetType()) {
-          case Standard:
-            player_.AddMoney(20);
-            break;
-          case Fast:
-            player_.AddMoney(35);
-            break;
-          case Big:
-            player_.AddMoney(50);
-            break;
-          case Magic:
-            player_.AddMoney(40);
-            break;
-          case Boss:
-            player_.AddMoney(100);
-            break;
-          default:
-            break;
-        }
-      }
-    }
+void PlayState::QuickSave() {
+  std::string file_path =
+      config_manager->GetValueOrDefault<std::string>("quicksave", "");
+  if (file_path.empty()) return;
+  if (runner_.Save(file_path, runner_.GetMap().GetName())) {
+    std::cout << "Saved the game to " << file_path << std::endl;
   }
 }
 
+void PlayState::QuickLoad() {
+  std::string file_path =
+      config_manager->GetValueOrDefault<std::string>("quicksave", "");
+  if (file_path.empty() || !runner_.Load(file_path)) return;
+  std::cout << "Loaded the game from " << file_path << std::endl;
+  // The towers were replaced
+  selected_tower_ = boost::none;
+  active_tower_ = boost::none;
+}
+
 void PlayState::HandleMapClick(int x, int y) {
-  // Click on a buildable tile with an active tower
-  if (active_tower_.get_ptr() != 0 && map_(x, y).GetType() == Empty &&
-      !towers_.count({x, y})) {
-    if (active_tower_.get().first == "basic") {
-      auto tower = towers_.insert(
-          {{x, y},
-           std::make_unique<BasicTower>(active_tower_->second->GetRange(),
-                                        active_tower_->second->GetDamage(),
-                                        active_tower_->second->GetAttSpeed(), x,
-                                        y, GetTileSize(),
-                                        active_tower_->second->GetPrice())});
-      selected_tower_ = tower.first->second.get();
-      selected_tower_->SetActive();
-      active_tower_ = boost::none;
-      gui_.at("sidegui").Get("cancelbuy").Hide();
-      InitTowerGUI(selected_tower_);
-    } else if (active_tower_.get().first == "money") {
-      auto tower = towers_.insert(
-          {{x, y},
-           std::make_unique<MoneyTower>(x, y, GetTileSize(),
-                                        active_tower_->second->GetPrice())});
-      selected_tower_ = tower.first->second.get();
-      selected_tower_->SetActive();
-      active_tower_ = boost::none;
-      gui_.at("sidegui").Get("cancelbuy").Hide();
-      InitTowerGUI(selected_tower_);
-      money_per_wave_ += selected_tower_->GetMoneyPerWave();
-    }
-  }
-  // Click on a water tile with an active tower
-  else if ((active_tower_.get_ptr() != 0) &&
-           (map_(x, y).GetType() == Water1 || map_(x, y).GetType() == Water2) &&
-           !towers_.count({x, y})) {
-    if (active_tower_.get().first == "ship") {
-      auto tower = towers_.insert(
-          {{x, y},
-           std::make_unique<ShipTower>(active_tower_->second->GetRange(),
-                                       active_tower_->second->GetDamage(),
-                                       active_tower_->second->GetAttSpeed(), x,
-                                       y, GetTileSize(),
-                                       active_tower_->second->GetPrice())});
-      selected_tower_ = tower.first->second.get();
-      selected_tower_->SetActive();
-      active_tower_ = boost::none;
-      gui_.at("sidegui").Get("cancelbuy").Hide();
-      InitTowerGUI(selected_tower_);
-    }
+  const Snapshot::TowerState* tower = FindTower(runner_.GetSnapshot(), {x, y});
+  // Click with a tower to build, the simulation refuses tiles it can't be
+  // built on
+  if (active_tower_.get_ptr() != 0) {
+    PlaceActiveTower(MakeTower(*active_tower_, x, y, runner_.GetTowerTable()));
   }
   // Click on a tower
-  else if (towers_.count({x, y}) && active_tower_.get_ptr() == 0) {
-    if (selected_tower_ != nullptr) {
-      selected_tower_->SetInactive();
-    }
-    auto tower = towers_.find({x, y});
-    selected_tower_ = tower->second.get();
-    selected_tower_->SetActive();
-    InitTowerGUI(selected_tower_);
+  else if (tower) {
+    selected_tower_ = tower->position;
+    InitTowerGUI(*tower);
   }
   // Click on a tile without any towers
   else {
-    if (selected_tower_ != nullptr) {
-      selected_tower_->SetInactive();
-    }
-    selected_tower_ = nullptr;
+    selected_tower_ = boost::none;
   }
 }
-void PlayState::HandleGuiClick(sf::Vector2f mouse_position) {
-  if (gui_.at("sidegui").Get("tower1").Contains(mouse_position)) {
-    for (auto& tower : towers_) {
-      tower.second->SetInactive();
-    }
-    // If we have an selected tower, remove the selection
-    if (selected_tower_ != nullptr) selected_tower_ = nullptr;
 
-    auto tower = BasicTower(5, 10, 1, mouse_position.x, mouse_position.y,
-                            GetTileSize(), 250);
+void PlayState::PlaceActiveTower(std::unique_ptr<Tower> tower) {
+  // The snapshot shows the tower only after the next step
+  Snapshot::TowerState placed = {tower->GetPosition(), tower->GetType(),
+                                 tower->GetCurrentUpgrade()};
+  if (!runner_.BuyTower(std::move(tower))) return;
+  selected_tower_ = placed.position;
+  active_tower_ = boost::none;
+  gui_.at("sidegui").Get("cancelbuy").Hide();
+  InitTowerGUI(placed);
+}
 
-    // Check if the player has enough money
-    if (player_.GetMoney() >= tower.GetPrice()) {
-      active_tower_ =
-          std::make_pair("basic", std::make_unique<BasicTower>(tower));
-      active_tower_->second->SetActive();
-      player_.AddMoney(-active_tower_.get().second->GetPrice());
-      gui_.at("sidegui").Get("cancelbuy").Show();
-    }
-  } else if (gui_.at("sidegui").Get("tower2").Contains(mouse_position)) {
-    for (auto& tower : towers_) {
-      tower.second->SetInactive();
+void PlayState::HandleGuiClick(sf::Vector2f mouse_position) {
+  // Click on a tower in the shop
+  for (int i = 0; i < TOWER_TYPE_COUNT; i++) {
+    TowerTypes type = TowerTypes(i);
+    if (!gui_.at("sidegui").Get(GetShopEntryName(type)).Contains(
+            mouse_position)) {
+      continue;
     }
     // If we have an selected tower, remove the selection
-    if (selected_tower_ != nullptr) selected_tower_ = nullptr;
-
-    auto tower = ShipTower(8, 5, 1, mouse_position.x, mouse_position.y,
-                           GetTileSize(), 400);
-
+    selected_tower_ = boost::none;
     // Check if the player has enough money
-    if (player_.GetMoney() >= tower.GetPrice()) {
-      active_tower_ =
-          std::make_pair("ship", std::make_unique<ShipTower>(tower));
-      active_tower_->second->SetActive();
-      player_.AddMoney(-active_tower_.get().second->GetPrice());
+    if (runner_.GetSnapshot().money >=
+        runner_.GetTowerTable().GetPrice(type)) {
+      active_tower_ = type;
       gui_.at("sidegui").Get("cancelbuy").Show();
     }
-  } else if (gui_.at("sidegui").Get("tower3").Contains(mouse_position)) {
-    for (auto& tower : towers_) {
-      tower.second->SetInactive();
-    }
-    // If we have an selected tower, remove the selection
-    if (selected_tower_ != nullptr) selected_tower_ = nullptr;
-
-    auto tower =
-        MoneyTower(mouse_position.x, mouse_position.y, GetTileSize(), 300);
+    return;
+  }
 
-    // Check if the player has enough money
-    if (player_.GetMoney() >= tower.GetPrice()) {
-      active_tower_ =
-          std::make_pair("money", std::make_unique<MoneyTower>(tower));
-      active_tower_->second->SetActive();
-      player_.AddMoney(-active_tower_.get().second->GetPrice());
-      gui_.at("sidegui").Get("cancelbuy").Show();
-    }
-  } else if (gui_.at("sidegui").Get("nextwave").IsEnabled() &&
-             gui_.at("sidegui").Get("nextwave").Contains(mouse_position)) {
-    std::cout << "Spawning wave " << wave_ << std::endl;
-    AddToSpawnQueue(map_.LoadWave(wave_));
+  if (gui_.at("sidegui").Get("nextwave").IsEnabled() &&
+      gui_.at("sidegui").Get("nextwave").Contains(mouse_position)) {
+    std::cout << "Spawning wave " << runner_.GetSnapshot().wave + 1
+              << std::endl;
+    runner_.StartWave();
     gui_.at("sidegui").Get("nextwave").Disable();
-    wave_++;
   } else if (gui_.at("sidegui").Get("cancelbuy").Contains(mouse_position) &&
              active_tower_.get_ptr() != 0) {
-    player_.AddMoney(active_tower_.get().second->GetPrice());
     active_tower_ = boost::none;
     gui_.at("sidegui").Get("cancelbuy").Hide();
-  } else if (gui_.find("towergui") != gui_.end() &&
+  } else if (selected_tower_ &&
              gui_.at("towergui")
                  .Get("upgrade_tower")
                  .Contains(mouse_position) &&
              gui_.at("towergui").Get("upgrade_tower").IsEnabled()) {
-    if (player_.GetMoney() >= selected_tower_->GetUpgradePrice()) {
-      player_.AddMoney(-selected_tower_->GetUpgradePrice());
-      int current = selected_tower_->GetMoneyPerWave();
-      selected_tower_->Upgrade();
-      money_per_wave_ += selected_tower_->GetMoneyPerWave() - current;
-    }
-    UpdateTowerStats();
-    if (!selected_tower_->IsUpgradeable()) {
-      gui_.at("towergui").Get("upgrade_tower").Disable();
-      gui_.at("towergui").Get("upgrade_tower").SetTitle("Upgrade");
-    }
-
-  } else if (gui_.find("towergui") != gui_.end() &&
+    // The tower GUI follows once the snapshot shows the upgrade
+    runner_.UpgradeTower(*selected_tower_);
+  } else if (selected_tower_ &&
              gui_.at("towergui").Get("sell_tower").Contains(mouse_position)) {
-    player_.AddMoney(selected_tower_->GetPrice() / 2);
-    towers_.erase(selected_tower_->GetPosition());
-    selected_tower_ = nullptr;
+    runner_.SellTower(*selected_tower_);
+    selected_tower_ = boost::none;
   }
 }
 
-// Initializes the main GUI
+// Initializes the main GUI, with a shop entry for every tower type
 void PlayState::InitGUI() {
   Gui sidegui = Gui();
-  const int margin = 10;
-  const int top_margin = 20;
-  int map_size = GetTileSize() * map_.GetWidth();
-  sidegui.Add("tower1",
-              GuiEntry(sf::Vector2f(map_size, 0), boost::none,
-                       texture_manager.GetTexture("sprites/basic_tower.png"),
-                       boost::none));
-
-  int tower_width = sidegui.Get("tower1").GetWidth();
-  sidegui.Add(
-      "tower1_info",
-      GuiEntry(
-          sf::Vector2f(map_size + tower_width, tower_width / 2 - top_margin),
-          "Old Tower\nPrice: " + std::to_string(250), boost::none, font_));
-
-  int tower_height = sidegui.Get("tower1").GetHeight();
-  int enemies = std::count_if(enemies_.begin(), enemies_.end(),
-                              [](Enemy e) { return e.IsAlive(); });
-
-  sidegui.Add(
-      "tower2",
-      GuiEntry(sf::Vector2f(map_size, tower_height + margin), boost::none,
-               texture_manager.GetTexture("sprites/ship_tower.png"),
-               boost::none));
-
-  tower_width = sidegui.Get("tower2").GetWidth();
-  sidegui.Add(
-      "tower2_info",
-      GuiEntry(
-          sf::Vector2f(map_size + tower_width,
-                       tower_height + margin + tower_width / 2 - top_margin),
-          "Pirate Ship\nPrice: " + std::to_string(400), boost::none, font_));
-
-  tower_height += sidegui.Get("tower2").GetHeight();
-
-  sidegui.Add(
-      "tower3",
-      GuiEntry(sf::Vector2f(map_size, tower_height + margin), boost::none,
-               texture_manager.GetTexture("sprites/money_tower.png"),
-               boost::none));
-  tower_width = sidegui.Get("tower3").GetWidth();
+  for (int i = 0; i < TOWER_TYPE_COUNT; i++) {
+    TowerTypes type = TowerTypes(i);
+    int price = runner_.GetTowerTable().GetPrice(type);
+    std::string info = std::string(GetTowerDefinition(type).title) +
+                       "\nPrice: " + std::to_string(price);
+    sidegui.Add(GetShopEntryName(type),
+                GuiEntry(sf::Vector2f(0, 0), boost::none,
+                         texture_manager.GetTexture(GetTowerTextureName(type)),
+                         boost::none));
+    sidegui.Add(GetShopEntryName(type) + "_info",
+                GuiEntry(sf::Vector2f(0, 0), info, boost::none, font_));
+  }
+  sidegui.Add("wave", GuiEntry(sf::Vector2f(0, 0),
+                               GetWaveStats(runner_.GetSnapshot()),
+                               boost::none, font_));
+  sidegui.Add("player", GuiEntry(sf::Vector2f(0, 0),
+                                 GetPlayerStats(runner_.GetSnapshot()),
+                                 boost::none, font_));
+  sidegui.Add("nextwave",
+              GuiEntry(sf::Vector2f(0, 0), std::string("Next wave"),
+                       texture_manager.GetTexture("sprites/button.png"),
+                       font_));
   sidegui.Add(
-      "tower3_info",
-      GuiEntry(
-          sf::Vector2f(map_size + tower_width,
-                       tower_height + margin + tower_width / 2 - top_margin),
-          "Mine\nPrice: " + std::to_string(300), boost::none, font_));
-  tower_height += sidegui.Get("tower3").GetHeight();
+      "cancelbuy",
+      GuiEntry(sf::Vector2f(0, 0), std::string("Cancel buy"),
+               texture_manager.GetTexture("sprites/button.png"), font_, false));
+  gui_.insert({"sidegui", sidegui});
+  PositionSideGui();
+}
 
-  sidegui.Add(
-      "wave",
-      GuiEntry(
-          sf::Vector2f(map_size + margin, tower_height + margin),
-          std::string("Wave: " + std::to_string(wave_ - 1) + "\nEnemies: " +
-                      std::to_string(spawn_queue_.size() + enemies)),
+// Stacks the shop, the stats and the buttons right of the map
+void PlayState::PositionSideGui() {
+  const int margin = 10;
+  const int top_margin = 20;
+  int map_size = GetTileSize() * runner_.GetMap().GetWidth();
+  Gui& sidegui = gui_.at("sidegui");
+  int tower_height = 0;
+  for (int i = 0; i < TOWER_TYPE_COUNT; i++) {
+    std::string name = GetShopEntryName(TowerTypes(i));
+    int y = i == 0 ? 0 : tower_height + margin;
+    sidegui.Get(name).SetPosition(sf::Vector2f(map_size, y));
+    int tower_width = sidegui.Get(name).GetWidth();
+    sidegui.Get(name + "_info")
+        .SetPosition(sf::Vector2f(map_size + tower_width,
+                                  y + tower_width / 2 - top_margin));
+    tower_height = y + sidegui.Get(name).GetHeight();
+  }
 
-          boost::none, font_));
+  sidegui.Get("wave").SetPosition(
+      sf::Vector2f(map_size + margin, tower_height + margin));
   int wave_height = sidegui.Get("wave").GetHeight();
-
-  sidegui.Add("player",
-              GuiEntry(sf::Vector2f(map_size + margin,
-                                    tower_height + wave_height + 2 * margin),
-                       "Player: " + player_.GetName() +
-                           "\nMoney: " + std::to_string(player_.GetMoney()) +
-                           "\nLives: " + std::to_string(player_.GetLives()),
-                       boost::none, font_));
+  sidegui.Get("player").SetPosition(sf::Vector2f(
+      map_size + margin, tower_height + wave_height + 2 * margin));
   int player_height = sidegui.Get("player").GetHeight();
-  sidegui.Add(
-      "nextwave",
-      GuiEntry(sf::Vector2f(map_size, tower_height + wave_height +
-                                          player_height + 4 * margin),
-               std::string("Next wave"),
-               texture_manager.GetTexture("sprites/button.png"), font_));
+  sidegui.Get("nextwave").SetPosition(sf::Vector2f(
+      map_size, tower_height + wave_height + player_height + 4 * margin));
   int nextwave_height = sidegui.Get("nextwave").GetHeight();
+  sidegui.Get("cancelbuy").SetPosition(
+      sf::Vector2f(map_size, tower_height + wave_height + player_height +
+                                 nextwave_height + 4 * margin));
+}
 
-  sidegui.Add(
-      "cancelbuy",
-      GuiEntry(
-          sf::Vector2f(map_size, tower_height + wave_height + player_height +
-                                     nextwave_height + 4 * margin),
-          std::string("Cancel buy"),
-          texture_manager.GetTexture("sprites/button.png"), font_, false));
+// The name of the type's entry in the shop, its description is the name
+// followed by "_info"
+std::string PlayState::GetShopEntryName(TowerTypes type) const {
+  return "tower_" + GetTowerTypeName(type);
+}
 
-  gui_.insert({"sidegui", sidegui});
+const Snapshot::TowerState* PlayState::FindTower(
+    const Snapshot& snapshot, const std::pair<int, int>& position) const {
+  for (auto& tower : snapshot.towers) {
+    if (tower.position == position) return &tower;
+  }
+  return nullptr;
 }
 
 // Initializes the tower GUI
-void PlayState::InitTowerGUI(Tower* selected_tower) {
+void PlayState::InitTowerGUI(const Snapshot::TowerState& tower) {
   Gui towergui = Gui();
   const int margin = 10;
-  int map_size = GetTileSize() * map_.GetHeight();
-  towergui.Add("tower", GuiEntry(sf::Vector2f(0, map_size), boost::none,
-                                 selected_tower_->GetTexture(), boost::none));
+  int map_size = GetTileSize() * runner_.GetMap().GetHeight();
+  towergui.Add("tower",
+               GuiEntry(sf::Vector2f(0, map_size), boost::none,
+                        texture_manager.GetTexture(
+                            GetTowerTextureName(tower.type)),
+                        boost::none));
 
   int tower_width = towergui.Get("tower").GetWidth();
 
-  towergui.Add(
-      "tower_stats",
-      GuiEntry(
-          sf::Vector2f(tower_width + margin, map_size),
-          "Level: " +
-              boost::str(boost::format("%.1f") %
-                         selected_tower_->GetCurrentUpgrade()) +
-              "\nRange: " +
-              boost::str(boost::format("%.1f") % selected_tower_->GetRange()) +
-              "\nDamage: " +
-              boost::str(boost::format("%.1f") % selected_tower_->GetDamage()) +
-              "\nAttack speed: " +
-              boost::str(boost::format("%.1f") %
-                         selected_tower_->GetAttSpeed()),
-          boost::none, font_));
+  towergui.Add("tower_stats",
+               GuiEntry(sf::Vector2f(tower_width + margin, map_size),
+                        GetTowerStats(tower), boost::none, font_));
   int tower_stats_width = towergui.Get("tower_stats").GetWidth();
 
   towergui.Add(
       "upgrade_tower",
       GuiEntry(
           sf::Vector2f(tower_width + tower_stats_width + 2 * margin, map_size),
-          std::string("Upgrade (" +
-                      std::to_string(selected_tower_->GetUpgradePrice()) + ")"),
+          "Upgrade (" +
+              std::to_string(runner_.GetTowerTable()
+                                 .GetLevel(tower.type, tower.level)
+                                 .upgrade_price) +
+              ")",
           texture_manager.GetTexture("sprites/button.png"), font_));
-  if (!selected_tower->IsUpgradeable()) {
-    towergui.Get("upgrade_tower").Disable();
-    towergui.Get("upgrade_tower").SetTitle("Upgrade");
-  }
   int upgrade_tower_width = towergui.Get("upgrade_tower").GetWidth();
 
   towergui.Add(
@@ -664,39 +645,72 @@ void PlayState::InitTowerGUI(Tower* selected_tower) {
                texture_manager.GetTexture("sprites/button.png"), font_));
 
   gui_["towergui"] = towergui;
+  UpdateTowerStats(tower);
 }
 
-int PlayState::GetTileSize() const {
-  auto windowsize = this->game->window.getSize();
-  int tile_size_x = (windowsize.x - 200) / map_.GetWidth();
-  int tile_size_y = (windowsize.y - 200) / map_.GetHeight();
-  return std::min(tile_size_x, tile_size_y);
+int PlayState::GetTileSize() const { return tile_size_; }
+
+std::string PlayState::GetWaveStats(const Snapshot& snapshot) const {
+  std::string speed = isinf(this->game->GetTimeScale())
+                          ? "max"
+                          : boost::str(boost::format("%gx") %
+                                       this->game->GetTimeScale());
+  return "Wave: " + std::to_string(snapshot.wave) +
+         "\nEnemies: " + std::to_string(snapshot.enemies_remaining) +
+         "\nSpeed: " + speed;
 }
 
-void PlayState::UpdatePlayerStats() {
-  gui_.at("sidegui").Get("player").SetTitle(
-      "Player: " + player_.GetName() +
-      "\nMoney: " + std::to_string(player_.GetMoney()) +
-      "\nLives: " + std::to_string(player_.GetLives()));
+void PlayState::ShowGameOver() {
+  std::cout << "YOU LOST NOOB" << std::endl;
+  gui_.at("sidegui").Add(
+      "gameover",
+      GuiEntry(sf::Vector2f(this->game->window.getSize().x / 2,
+                            this->game->window.getSize().y / 2),
+               std::string("Game over!"),
+               texture_manager.GetTexture("sprites/button.png"), font_));
+  gui_.at("sidegui")
+      .Get("gameover")
+      .SetPosition(gui_.at("sidegui").Get("gameover").GetPosition() +
+                   sf::Vector2f(
+                       -gui_.at("sidegui").Get("gameover").GetWidth() / 2,
+                       -gui_.at("sidegui").Get("gameover").GetHeight() / 2));
+}
+
+std::string PlayState::GetPlayerStats(const Snapshot& snapshot) const {
+  return "Player: " + snapshot.player_name +
+         "\nMoney: " + std::to_string(snapshot.money) +
+         "\nLives: " + std::to_string(snapshot.lives);
+}
+
+void PlayState::UpdatePlayerStats(const Snapshot& snapshot) {
+  gui_.at("sidegui").Get("player").SetTitle(GetPlayerStats(snapshot));
+}
+
+std::string PlayState::GetTowerStats(
+    const Snapshot::TowerState& tower) const {
+  const TowerLevel& level =
+      runner_.GetTowerTable().GetLevel(tower.type, tower.level);
+  return "Level: " + boost::str(boost::format("%.1f") % tower.level) +
+         "\nRange: " + boost::str(boost::format("%.1f") % level.range) +
+         "\nDamage: " + boost::str(boost::format("%.1f") % level.damage) +
+         "\nAttack speed: " +
+         boost::str(boost::format("%.1f") % level.att_speed);
 }
 
-void PlayState::UpdateTowerStats() {
-  gui_.at("towergui")
-      .Get("tower_stats")
-      .SetTitle(
-          "Level: " +
-          boost::str(boost::format("%.1f") %
-                     selected_tower_->GetCurrentUpgrade()) +
-          "\nRange: " +
-          boost::str(boost::format("%.1f") % selected_tower_->GetRange()) +
-          "\nDamage: " +
-          boost::str(boost::format("%.1f") % selected_tower_->GetDamage()) +
-          "\nAttack speed: " +
-          boost::str(boost::format("%.1f") % selected_tower_->GetAttSpeed()));
-
-  gui_.at("towergui")
-      .Get("upgrade_tower")
-      .SetTitle(std::string("Upgrade (" +
-                            std::to_string(selected_tower_->GetUpgradePrice()) +
-                            ")"));
+void PlayState::UpdateTowerStats(const Snapshot::TowerState& tower) {
+  const TowerTable& towers = runner_.GetTowerTable();
+  selected_level_ = tower.level;
+  gui_.at("towergui").Get("tower_stats").SetTitle(GetTowerStats(tower));
+
+  GuiEntry& upgrade = gui_.at("towergui").Get("upgrade_tower");
+  if (tower.level < towers.GetLevelCount(tower.type)) {
+    upgrade.Enable();
+    upgrade.SetTitle(
+        "Upgrade (" +
+        std::to_string(towers.GetLevel(tower.type, tower.level).upgrade_price) +
+        ")");
+  } else {
+    upgrade.Disable();
+    upgrade.SetTitle("Upgrade");
+  }
 }
\ No newline at end of file
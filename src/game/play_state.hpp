@@ -6,8 +6,9 @@
 #include "../gui/button.hpp"
 #include "../gui/gui.hpp"
 #include "../map/map.hpp"
-#include "../player/player.hpp"
+#include "../simulation/simulation_runner.hpp"
 #include "../tower/tower.hpp"
+#include "../tower/tower_types.hpp"
 #include "game_state.hpp"
 
 class PlayState : public GameState {
@@ -15,32 +16,62 @@ class PlayState : public GameState {
   PlayState(Game* game, Map map);
   virtual void Draw();
   virtual void HandleInput();
-  void Tick();
-  void AddToSpawnQueue(std::vector<Enemy> enemies);
-  void FindEnemies();
+  virtual void Update();
+  void DrawMap();
+  void UpdateMapLayer();
+  void DrawEnemies(const Snapshot& snapshot);
+  void DrawTowers(const Snapshot& snapshot);
+  void DrawRange(float range, sf::Vector2f position);
+  void DrawTarget(const Snapshot& snapshot, const std::pair<int, int>& tower,
+                  sf::Vector2f position);
   void HandleMapClick(int x, int y);
   void HandleGuiClick(sf::Vector2f mouse_position);
+  void PlaceActiveTower(std::unique_ptr<Tower> tower);
+  // Shows the timers and counters of the profiler
+  void DrawProfiler();
+  // Writes the recent timers to the "trace" file
+  void WriteTrace();
+  // Save the game to and load it from the "quicksave" file
+  void QuickSave();
+  void QuickLoad();
   void InitGUI();
-  void InitTowerGUI(Tower* selected_tower);
+  void PositionSideGui();
+  std::string GetShopEntryName(TowerTypes type) const;
+  // The tower at position in the snapshot, nullptr if there is none
+  const Snapshot::TowerState* FindTower(
+      const Snapshot& snapshot, const std::pair<int, int>& position) const;
+  void InitTowerGUI(const Snapshot::TowerState& tower);
+  void ShowGameOver();
   int GetTileSize() const;
-  void UpdatePlayerStats();
-  void UpdateTowerStats();
+  std::string GetWaveStats(const Snapshot& snapshot) const;
+  std::string GetPlayerStats(const Snapshot& snapshot) const;
+  void UpdatePlayerStats(const Snapshot& snapshot);
+  std::string GetTowerStats(const Snapshot::TowerState& tower) const;
+  void UpdateTowerStats(const Snapshot::TowerState& tower);
 
  private:
-  Map map_;
-  std::vector<Enemy> enemies_;
-  std::deque<Enemy> spawn_queue_;
-  std::map<std::pair<int, int>, std::unique_ptr<Tower>> towers_;
+  JobSystem jobs_;
+  // Steps the game on its own thread, drawing only reads its snapshots
+  SimulationRunner runner_;
   sf::View view_;
   sf::Sprite background_;
   sf::Font font_;
   std::map<std::string, Button> buttons_;
   std::map<std::string, Gui> gui_;
-  boost::optional<std::pair<std::string, std::unique_ptr<Tower>>> active_tower_;
-  Tower* selected_tower_;
-  sf::Clock clock_;
-  float last_spawn_;
-  int wave_;
-  int money_per_wave_;
-  Player player_;
-};
\ No newline at end of file
+  // The map only changes when the window is resized, so it is drawn once
+  // into a texture which is then drawn as a single sprite every frame
+  int tile_size_;
+  sf::RenderTexture map_layer_;
+  sf::Sprite map_sprite_;
+  // Quads using the texture atlas, refilled every frame
+  sf::VertexArray enemy_vertices_;
+  sf::VertexArray hp_bar_vertices_;
+  sf::VertexArray tower_vertices_;
+  // The type bought in the shop, placed with the next click on the map
+  boost::optional<TowerTypes> active_tower_;
+  // The selected tower by its position, and the level the tower GUI shows
+  boost::optional<std::pair<int, int>> selected_tower_;
+  int selected_level_;
+  bool show_profiler_;
+  sf::VertexArray profiler_vertices_;
+};
@@ -0,0 +1,138 @@
+#include "texture_atlas.hpp"
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <iostream>
+#include <vector>
+
+namespace {
+// Larger images, like the backgrounds, are left out of the atlas
+const unsigned MAX_SPRITE_SIZE = 512;
+// Space between the sprites so that scaled sprites don't bleed into each other
+const unsigned PADDING = 2;
+}  // namespace
+
+TextureAtlas& TextureAtlas::GetInstance() {
+  static TextureAtlas instance;
+  return instance;
+}
+
+// Packs every png image in the directory into the atlas. The sprites are
+// named like the textures of the texture manager, e.g. "sprites/tree_1.png".
+bool TextureAtlas::Load(const std::string& directory) {
+  std::vector<std::pair<std::string, sf::Image>> images;
+  boost::system::error_code error;
+  for (boost::filesystem::directory_iterator it(directory, error), end;
+       it != end; it.increment(error)) {
+    if (it->path().extension() != ".png") {
+      continue;
+    }
+    sf::Image image;
+    std::string name = directory + "/" + it->path().filename().string();
+    if (!image.loadFromFile(name)) {
+      std::cout << "Failed to load " << name << std::endl;
+      continue;
+    }
+    if (image.getSize().x <= MAX_SPRITE_SIZE &&
+        image.getSize().y <= MAX_SPRITE_SIZE) {
+      images.push_back({name, image});
+    }
+  }
+  if (error) {
+    std::cout << "Failed to read " << directory << std::endl;
+    return false;
+  }
+  sf::Image white;
+  white.create(4, 4, sf::Color::White);
+  images.push_back({"", white});
+
+  // Place the images in rows, tallest first, and grow the atlas until they
+  // all fit
+  std::sort(images.begin(), images.end(),
+            [](const std::pair<std::string, sf::Image>& a,
+               const std::pair<std::string, sf::Image>& b) {
+              return a.second.getSize().y > b.second.getSize().y;
+            });
+  unsigned max_size = sf::Texture::getMaximumSize();
+  for (unsigned size = 512; size <= max_size; size *= 2) {
+    std::vector<sf::IntRect> rects;
+    unsigned x = 0, y = 0, row_height = 0;
+    for (auto& image : images) {
+      sf::Vector2u image_size = image.second.getSize();
+      if (x + image_size.x > size) {
+        x = 0;
+        y += row_height + PADDING;
+        row_height = 0;
+      }
+      rects.push_back(sf::IntRect(x, y, image_size.x, image_size.y));
+      x += image_size.x + PADDING;
+      row_height = std::max(row_height, image_size.y);
+    }
+    if (y + row_height > size) {
+      continue;
+    }
+
+    sf::Image atlas;
+    atlas.create(size, y + row_height, sf::Color::Transparent);
+    rects_.clear();
+    for (size_t i = 0; i < images.size(); i++) {
+      atlas.copy(images[i].second, rects[i].left, rects[i].top);
+      if (images[i].first.empty()) {
+        // Sample the middle of the white area only
+        white_rect_ = sf::IntRect(rects[i].left + 1, rects[i].top + 1, 2, 2);
+      } else {
+        rects_[images[i].first] = rects[i];
+      }
+    }
+    return texture_.loadFromImage(atlas);
+  }
+  std::cout << "The sprites in " << directory << " don't fit in a texture"
+            << std::endl;
+  return false;
+}
+
+bool TextureAtlas::IsLoaded() const { return !rects_.empty(); }
+
+const sf::Texture& TextureAtlas::GetTexture() const { return texture_; }
+
+sf::IntRect TextureAtlas::GetRect(const std::string& name) const {
+  auto rect = rects_.find(name);
+  if (rect == rects_.end()) {
+    std::cout << "No sprite " << name << " in the texture atlas" << std::endl;
+    return white_rect_;
+  }
+  return rect->second;
+}
+
+void TextureAtlas::AppendSprite(sf::VertexArray& vertices,
+                                const std::string& name,
+                                const sf::FloatRect& bounds) const {
+  AppendQuad(vertices, bounds, sf::FloatRect(GetRect(name)), sf::Color::White);
+}
+
+void TextureAtlas::AppendRect(sf::VertexArray& vertices,
+                              const sf::FloatRect& bounds,
+                              const sf::Color& color) const {
+  AppendQuad(vertices, bounds, sf::FloatRect(white_rect_), color);
+}
+
+void TextureAtlas::AppendQuad(sf::VertexArray& vertices,
+                              const sf::FloatRect& bounds,
+                              const sf::FloatRect& texture_rect,
+                              const sf::Color& color) const {
+  float left = bounds.left;
+  float top = bounds.top;
+  float right = bounds.left + bounds.width;
+  float bottom = bounds.top + bounds.height;
+  float texture_left = texture_rect.left;
+  float texture_top = texture_rect.top;
+  float texture_right = texture_rect.left + texture_rect.width;
+  float texture_bottom = texture_rect.top + texture_rect.height;
+  vertices.append(sf::Vertex(sf::Vector2f(left, top), color,
+                             sf::Vector2f(texture_left, texture_top)));
+  vertices.append(sf::Vertex(sf::Vector2f(right, top), color,
+                             sf::Vector2f(texture_right, texture_top)));
+  vertices.append(sf::Vertex(sf::Vector2f(right, bottom), color,
+                             sf::Vector2f(texture_right, texture_bottom)));
+  vertices.append(sf::Vertex(sf::Vector2f(left, bottom), color,
+                             sf::Vector2f(texture_left, texture_bottom)));
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <map>
+#include <string>
+
+// All the small sprites packed into one texture, so that everything drawn
+// with them can go into a single vertex array and be drawn with one call.
+class TextureAtlas {
+ public:
+  static TextureAtlas& GetInstance();
+  bool Load(const std::string& directory);
+  bool IsLoaded() const;
+  const sf::Texture& GetTexture() const;
+  sf::IntRect GetRect(const std::string& name) const;
+  // Adds a quad covering bounds with the named sprite
+  void AppendSprite(sf::VertexArray& vertices, const std::string& name,
+                    const sf::FloatRect& bounds) const;
+  // Adds a quad covering bounds in a solid color
+  void AppendRect(sf::VertexArray& vertices, const sf::FloatRect& bounds,
+                  const sf::Color& color) const;
+
+  TextureAtlas(TextureAtlas const&) = delete;
+  void operator=(TextureAtlas const&) = delete;
+
+ private:
+  TextureAtlas() {}
+  void AppendQuad(sf::VertexArray& vertices, const sf::FloatRect& bounds,
+                  const sf::FloatRect& texture_rect,
+                  const sf::Color& color) const;
+
+  sf::Texture texture_;
+  std::map<std::string, sf::IntRect> rects_;
+  // A white area in the atlas used for solid colors
+  sf::IntRect white_rect_;
+};
+
+#define texture_atlas TextureAtlas::GetInstance()
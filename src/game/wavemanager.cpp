@@ -1,13 +1,17 @@
 #include "wavemanager.hpp"
 #include <boost/filesystem.hpp>
 #include <boost/property_tree/json_parser.hpp>
+#include <iostream>
 
 WaveManager& WaveManager::GetInstance() {
   static WaveManager instance;
   return instance;
 }
 
+// Reads the waves file and compiles it into the wave table. The whole file is
+// checked here, so starting a wave later can't fail.
 bool WaveManager::ParseFile(const std::string& file_path) {
+  waves_.Clear();
   if (!boost::filesystem::exists(file_path)) {
     return false;
   }
@@ -16,16 +20,23 @@ bool WaveManager::ParseFile(const std::string& file_path) {
 
     boost::property_tree::json_parser::read_json(file_path, full_tree);
 
-    if (full_tree.empty()) {
+    auto waves = full_tree.get_child_optional("waves");
+    if (!waves) {
+      std::cout << file_path << ": No waves found" << std::endl;
       return false;
     }
-    config_ = full_tree;
+    WaveTable table;
+    std::string error_message;
+    if (!table.Load(*waves, error_message)) {
+      std::cout << file_path << ": " << error_message << std::endl;
+      return false;
+    }
+    waves_ = table;
   } catch (boost::property_tree::json_parser::json_parser_error const& e) {
+    std::cout << file_path << ": " << e.message() << std::endl;
     return false;
   }
   return true;
 }
 
-boost::property_tree::ptree WaveManager::GetSubTree(const std::string& name) {
-  return config_.get_child(name);
-}
\ No newline at end of file
+const WaveTable& WaveManager::GetWaves() const { return waves_; }
@@ -1,20 +1,19 @@
 #pragma once
-#include <boost/property_tree/ptree.hpp>
 #include <string>
+#include "../map/wave_table.hpp"
 
 class WaveManager {
  public:
   static WaveManager& GetInstance();
   bool ParseFile(const std::string& file_path);
-
-  boost::property_tree::ptree GetSubTree(const std::string& name);
+  const WaveTable& GetWaves() const;
 
   WaveManager(WaveManager const&) = delete;
   void operator=(WaveManager const&) = delete;
 
  private:
   WaveManager() {}
-  boost::property_tree::ptree config_;
+  WaveTable waves_;
 };
 
-#define wave_manager WaveManager::GetInstance()
\ No newline at end of file
+#define wave_manager WaveManager::GetInstance()
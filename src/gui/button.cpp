@@ -1,6 +1,7 @@
 #include "button.hpp"
 #include <iostream>
 #include "../game/texturemanager.hpp"
+#include "../profiler/profiler.hpp"
 
 Button::Button(std::string title, sf::Font& font, sf::Vector2f position,
                const std::string& texture_name)
@@ -36,4 +37,5 @@ const sf::Vector2f Button::GetPosition() const { return position_; };
 void Button::draw(sf::RenderTarget& target, sf::RenderStates states) const {
   target.draw(sprite_, states);
   target.draw(title_, states);
+  PROFILE_COUNT(Frame, "Draw calls", 2);
 }
\ No newline at end of file
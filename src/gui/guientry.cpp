@@ -1,6 +1,7 @@
 #include "guientry.hpp"
 #include <iostream>
 #include "../game/texturemanager.hpp"
+#include "../profiler/profiler.hpp"
 
 GuiEntry::GuiEntry(sf::Vector2f position, boost::optional<std::string> title,
                    boost::optional<sf::Texture&> texture,
@@ -96,5 +97,7 @@ void GuiEntry::draw(sf::RenderTarget& target, sf::RenderStates states) const {
   if (visible_) {
     if (sprite_.get_ptr() != 0) target.draw(sprite_.get(), states);
     if (title_.get_ptr() != 0) target.draw(title_.get(), states);
+    PROFILE_COUNT(Frame, "Draw calls",
+                  (sprite_.get_ptr() != 0) + (title_.get_ptr() != 0));
   }
 }
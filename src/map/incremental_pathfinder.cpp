@@ -0,0 +1,166 @@
+#include "incremental_pathfinder.hpp"
+#include <stdlib.h>
+#include <algorithm>
+#include <limits>
+#include "map.hpp"
+#include "pathfinder.hpp"
+
+namespace {
+const int INFINITE_COST = std::numeric_limits<int>::max() / 2;
+}
+
+bool operator<(const IncrementalPathfinder::Key& l,
+               const IncrementalPathfinder::Key& r) {
+  if (l.first != r.first) return l.first < r.first;
+  return l.second < r.second;
+}
+
+bool operator>(const IncrementalPathfinder::Entry& l,
+               const IncrementalPathfinder::Entry& r) {
+  return r.key < l.key;
+}
+
+IncrementalPathfinder::IncrementalPathfinder()
+    : width_(0), height_(0), start_(0), goal_(0) {}
+
+void IncrementalPathfinder::Reset(const Map& map) {
+  width_ = map.GetWidth();
+  height_ = map.GetHeight();
+  start_ = map.GetEnemySpawn().second * width_ + map.GetEnemySpawn().first;
+  goal_ = map.GetPlayerBase().second * width_ + map.GetPlayerBase().first;
+  grid_ = Pathfinder::GetGrid(map);
+  g_.assign(grid_.size(), INFINITE_COST);
+  rhs_.assign(grid_.size(), INFINITE_COST);
+  open_list_ = decltype(open_list_)();
+  // A map without tiles or with the spawn or the base outside it has no path,
+  // an empty grid makes GetPath return none
+  auto in_map = [&map](const std::pair<int, int>& tile) {
+    return tile.first >= 0 && tile.second >= 0 &&
+           tile.first < map.GetWidth() && tile.second < map.GetHeight();
+  };
+  if (!in_map(map.GetEnemySpawn()) || !in_map(map.GetPlayerBase())) {
+    grid_.clear();
+    return;
+  }
+
+  rhs_[start_] = 0;
+  open_list_.push({CalculateKey(start_), start_});
+}
+
+void IncrementalPathfinder::SetTraversable(int x, int y, bool traversable) {
+  if (grid_.empty()) return;
+  int index = y * width_ + x;
+  if (grid_[index] == traversable) return;
+  grid_[index] = traversable;
+  // The costs of all edges to and from the tile changed
+  UpdateVertex(index);
+  int neighbours[4];
+  int count = GetNeighbours(index, neighbours);
+  for (int i = 0; i < count; i++) {
+    UpdateVertex(neighbours[i]);
+  }
+}
+
+// Repairs the search and returns the path from the enemy spawn to the player
+// base, or an empty path if there is none
+std::vector<std::pair<int, int>> IncrementalPathfinder::GetPath() {
+  std::vector<std::pair<int, int>> path;
+  if (grid_.empty()) return path;
+  ComputeShortestPath();
+  if (g_[goal_] >= INFINITE_COST) return path;
+
+  // Walk back from the base, always to the neighbour closest to the spawn
+  int cur = goal_;
+  path.push_back({cur % width_, cur / width_});
+  while (cur != start_) {
+    int neighbours[4];
+    int count = GetNeighbours(cur, neighbours);
+    int best = -1;
+    for (int i = 0; i < count; i++) {
+      if (grid_[neighbours[i]] &&
+          (best == -1 || g_[neighbours[i]] < g_[best])) {
+        best = neighbours[i];
+      }
+    }
+    if (best == -1 || g_[best] >= g_[cur]) return {};
+    cur = best;
+    path.push_back({cur % width_, cur / width_});
+  }
+  std::reverse(path.begin(), path.end());
+  return path;
+}
+
+int IncrementalPathfinder::Heuristic(int index) const {
+  return abs(index % width_ - goal_ % width_) +
+         abs(index / width_ - goal_ / width_);
+}
+
+IncrementalPathfinder::Key IncrementalPathfinder::CalculateKey(
+    int index) const {
+  int cost = std::min(g_[index], rhs_[index]);
+  return {cost + Heuristic(index), cost};
+}
+
+void IncrementalPathfinder::UpdateVertex(int index) {
+  if (index != start_) {
+    rhs_[index] = INFINITE_COST;
+    if (grid_[index]) {
+      int neighbours[4];
+      int count = GetNeighbours(index, neighbours);
+      for (int i = 0; i < count; i++) {
+        if (grid_[neighbours[i]]) {
+          rhs_[index] = std::min(rhs_[index], g_[neighbours[i]] + 1);
+        }
+      }
+    }
+  }
+  if (g_[index] != rhs_[index]) {
+    open_list_.push({CalculateKey(index), index});
+  }
+}
+
+// Drops outdated entries and checks if the smallest key is below the given one
+bool IncrementalPathfinder::TopKeyLess(const Key& key) {
+  while (!open_list_.empty()) {
+    const Entry& top = open_list_.top();
+    Key current = CalculateKey(top.index);
+    if (g_[top.index] == rhs_[top.index] || current < top.key ||
+        top.key < current) {
+      open_list_.pop();
+      continue;
+    }
+    return top.key < key;
+  }
+  return false;
+}
+
+void IncrementalPathfinder::ComputeShortestPath() {
+  while (TopKeyLess(CalculateKey(goal_)) || rhs_[goal_] != g_[goal_]) {
+    if (open_list_.empty()) break;
+    int index = open_list_.top().index;
+    open_list_.pop();
+    if (g_[index] > rhs_[index]) {
+      g_[index] = rhs_[index];
+    } else {
+      g_[index] = INFINITE_COST;
+      UpdateVertex(index);
+    }
+    int neighbours[4];
+    int count = GetNeighbours(index, neighbours);
+    for (int i = 0; i < count; i++) {
+      UpdateVertex(neighbours[i]);
+    }
+  }
+}
+
+// Fills in the tiles next to the given one and returns how many there are
+int IncrementalPathfinder::GetNeighbours(int index, int neighbours[4]) const {
+  int count = 0;
+  int x = index % width_;
+  int y = index / width_;
+  if (y > 0) neighbours[count++] = index - width_;
+  if (y < height_ - 1) neighbours[count++] = index + width_;
+  if (x > 0) neighbours[count++] = index - 1;
+  if (x < width_ - 1) neighbours[count++] = index + 1;
+  return count;
+}
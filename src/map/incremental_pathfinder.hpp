@@ -0,0 +1,48 @@
+#pragma once
+#include <functional>
+#include <queue>
+#include <vector>
+
+class Map;
+
+// Lifelong Planning A* (LPA*) from the enemy spawn to the player base. Unlike
+// Pathfinder::GetPath it keeps its search state between calls, so when tiles
+// are blocked or opened only the part of the search they affect is redone.
+class IncrementalPathfinder {
+ public:
+  IncrementalPathfinder();
+  void Reset(const Map& map);
+  void SetTraversable(int x, int y, bool traversable);
+  std::vector<std::pair<int, int>> GetPath();
+
+ private:
+  struct Key {
+    int first;
+    int second;
+  };
+  struct Entry {
+    Key key;
+    int index;
+  };
+  friend bool operator<(const Key& l, const Key& r);
+  friend bool operator>(const Entry& l, const Entry& r);
+
+  int Heuristic(int index) const;
+  Key CalculateKey(int index) const;
+  void UpdateVertex(int index);
+  bool TopKeyLess(const Key& key);
+  void ComputeShortestPath();
+  int GetNeighbours(int index, int neighbours[4]) const;
+
+  int width_;
+  int height_;
+  int start_;
+  int goal_;
+  std::vector<unsigned char> grid_;
+  std::vector<int> g_;
+  std::vector<int> rhs_;
+  // Entries are not removed when a tile's key changes, outdated entries are
+  // skipped when they reach the top instead
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>>
+      open_list_;
+};
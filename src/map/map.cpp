@@ -1,10 +1,11 @@
 #include "map.hpp"
-#include <boost/property_tree/ptree.hpp>
+#include <algorithm>
 #include <iostream>
+#include <queue>
 #include "../game/wavemanager.hpp"
-#include "pathfinder.hpp"
+#include "map_bundle.hpp"
 
-Map::Map() {}
+Map::Map() : width_(0), height_(0) {}
 
 void Map::Load(const std::string& filename) {
   std::string path = "maps/" + GetName() + "/" + filename;
@@ -12,141 +13,430 @@ void Map::Load(const std::string& filename) {
   if (!is.is_open()) {
     std::cout << "Failed to open " << path << std::endl;
   } else {
-    std::string line;
-    int i = 0;
-    while (std::getline(is, line)) {
-      tiles_.push_back(std::vector<Tile>());
-      int j = 0;
-      for (auto c : line) {
-        switch (c) {
-          case '0':
-            tiles_[i].push_back(Tile(Empty));
-            break;
-          case '#':
-            tiles_[i].push_back(Tile(Path));
-            break;
-          case 'T':
-            tiles_[i].push_back(Tile(Tree1));
-            break;
-          case 't':
-            tiles_[i].push_back(Tile(Tree2));
-            break;
-          case 'd':
-            tiles_[i].push_back(Tile(Tree3));
-            break;
-          case 'W':
-            tiles_[i].push_back(Tile(Water1));
-            break;
-          case 'V':
-            tiles_[i].push_back(Tile(Water2));
-            break;
-          case 'w':
-            tiles_[i].push_back(Tile(Water3));
-            break;
-          case 'B':
-            tiles_[i].push_back(Tile(PlayerBase));
-            player_base_ = std::pair<int, int>(j, i);
-            break;
-          case 'S':
-            tiles_[i].push_back(Tile(EnemySpawn));
-            enemy_spawn_ = std::pair<int, int>(j, i);
-            break;
-          default:
-            tiles_[i].push_back(Tile(Empty));
-            break;
-        }
-        j++;
+    Load(is);
+  }
+  is.close();
+}
+
+// Reads the map from a stream in the same format as the map files
+void Map::Load(std::istream& is) {
+  std::vector<std::string> lines;
+  std::string line;
+  width_ = 0;
+  while (std::getline(is, line)) {
+    lines.push_back(line);
+    width_ = std::max(width_, int(line.size()));
+  }
+  height_ = lines.size();
+  waves_.Clear();
+  path_.clear();
+  // The flow field is calculated from scratch, not repaired
+  distances_.clear();
+  changed_tiles_.clear();
+  enemy_spawn_ = player_base_ = {-1, -1};
+  // Rows shorter than the widest one are filled up with empty tiles
+  tiles_.assign(width_ * height_, Empty);
+  for (int y = 0; y < height_; y++) {
+    for (size_t x = 0; x < lines[y].size(); x++) {
+      TileTypes type;
+      switch (lines[y][x]) {
+        case '0':
+          type = Empty;
+          break;
+        case '#':
+          type = Path;
+          break;
+        case 'T':
+          type = Tree1;
+          break;
+        case 't':
+          type = Tree2;
+          break;
+        case 'd':
+          type = Tree3;
+          break;
+        case 'W':
+          type = Water1;
+          break;
+        case 'V':
+          type = Water2;
+          break;
+        case 'w':
+          type = Water3;
+          break;
+        case 'B':
+          type = PlayerBase;
+          player_base_ = std::pair<int, int>(x, y);
+          break;
+        case 'S':
+          type = EnemySpawn;
+          enemy_spawn_ = std::pair<int, int>(x, y);
+          break;
+        default:
+          type = Empty;
+          break;
       }
-      i++;
+      tiles_[y * width_ + x] = type;
     }
   }
-  is.close();
+  pathfinder_.Reset(*this);
+  // Without a spawn and a base there is no path, the map stays without one
+  if (enemy_spawn_.first == -1 || player_base_.first == -1) {
+    std::cout << "The map needs an enemy spawn and a player base"
+              << std::endl;
+    distances_.assign(GetWidth() * GetHeight(), -1);
+    flow_field_.assign(GetWidth() * GetHeight(), -1);
+    return;
+  }
   RecalculatePath();
 }
 
-void Map::Draw(sf::RenderWindow& window) {
-  auto windowsize = window.getSize();
-  int tile_size_x = (windowsize.x - 200) / GetWidth();
-  int tile_size_y = (windowsize.y - 200) / GetHeight();
-  tile_size = std::min(tile_size_x, tile_size_y);
-  for (int y = 0; y < GetHeight(); y++) {
-    for (int x = 0; x < GetWidth(); x++) {
-      Tile tile = tiles_[y][x];
-      tile.SetPosition(x * tile_size, y * tile_size);
-      tile.SetScale(tile_size);
-      window.draw(tile);
+// Loads a map bundle written by SaveBundle. Nothing is parsed or searched,
+// the sections of the file are copied straight into the map.
+bool Map::LoadBundle(const std::string& file_path) {
+  MapBundle::File file;
+  if (!file.Open(file_path)) {
+    return false;
+  }
+  const MapBundle::Header& header = file.GetHeader();
+  width_ = header.width;
+  height_ = header.height;
+  const int tile_count = width_ * height_;
+  tiles_.assign(file.GetTiles(), file.GetTiles() + tile_count);
+  enemy_spawn_ = {header.spawn_x, header.spawn_y};
+  player_base_ = {header.base_x, header.base_y};
+  path_.resize(header.path_length);
+  for (size_t i = 0; i < path_.size(); i++) {
+    path_[i] = {file.GetPath()[2 * i], file.GetPath()[2 * i + 1]};
+  }
+  distances_.assign(file.GetDistances(), file.GetDistances() + tile_count);
+  flow_field_.assign(file.GetFlowField(), file.GetFlowField() + tile_count);
+  changed_tiles_.clear();
+  waves_.Clear();
+  for (uint32_t wave = 0; wave < header.wave_count; wave++) {
+    waves_.AddWave();
+    uint32_t end = wave + 1 < header.wave_count ? file.GetWaveStarts()[wave + 1]
+                                                : header.group_count;
+    for (uint32_t i = file.GetWaveStarts()[wave]; i < end; i++) {
+      const MapBundle::Group& group = file.GetGroups()[i];
+      waves_.AddGroup({EnemyTypes(group.type), group.amount, group.max_hp,
+                       group.speed, group.delay});
     }
   }
+  pathfinder_.Reset(*this);
+  return true;
 }
 
-int Map::GetHeight() const { return tiles_.size(); }
+bool Map::SaveBundle(const std::string& file_path) const {
+  return MapBundle::Write(file_path, *this);
+}
 
-int Map::GetWidth() const { return tiles_[0].size(); }
+int Map::GetHeight() const { return height_; }
+
+int Map::GetWidth() const { return width_; }
 
 void Map::SetName(const std::string& name) { name_ = name; }
 
-std::string Map::GetName() { return name_; }
+std::string Map::GetName() const { return name_; }
 
 const std::pair<int, int> Map::GetEnemySpawn() const { return enemy_spawn_; }
 
 const std::pair<int, int> Map::GetPlayerBase() const { return player_base_; }
 
-const std::vector<std::vector<Tile>> Map::GetTiles() const { return tiles_; }
+const std::vector<uint8_t>& Map::GetTiles() const { return tiles_; }
 
-const Tile& Map::operator()(int x, int y) { return tiles_[y][x]; }
+TileTypes Map::operator()(int x, int y) const {
+  return TileTypes(tiles_[y * width_ + x]);
+}
 
+// Changes a tile. Call RecalculatePath afterwards to update the enemy path,
+// only the part of the search and of the flow field affected by the change is
+// redone. Towers don't change tiles, so only td-bench calls it for now.
+void Map::SetTile(int x, int y, TileTypes type) {
+  tiles_[y * width_ + x] = type;
+  pathfinder_.SetTraversable(x, y, IsTraversable(type));
+  changed_tiles_.push_back(y * width_ + x);
+}
+
+// Without a path the tiles changed all the same, so the flow field is
+// searched again from scratch and the next repair starts from there
 bool Map::RecalculatePath() {
-  auto new_path = Pathfinder::GetPath(*this);
+  auto new_path = pathfinder_.GetPath();
   if (new_path.size() <= 1) {
     std::cout << "Error calculating the enemy path" << std::endl;
+    path_.clear();
+    CalculateFlowField();
+    changed_tiles_.clear();
     return false;
   } else {
-    path_ = new_path;
+    std::vector<std::pair<int, int>> old_path = std::move(path_);
+    path_ = std::move(new_path);
+    if (distances_.size() == tiles_.size()) {
+      RepairFlowField(old_path);
+    } else {
+      CalculateFlowField();
+    }
+    changed_tiles_.clear();
     return true;
   }
 }
 
-std::vector<std::pair<int, int>> Map::GetPath() const { return path_; }
-
-std::vector<Enemy> Map::LoadWave(int wave) {
-  std::vector<Enemy> enemies;
-  try {
-    for (boost::property_tree::ptree::value_type& monsters :
-         wave_manager.GetSubTree("waves." + std::to_string(wave))) {
-      EnemyTypes enemy_type;
-      for (boost::property_tree::ptree::value_type& monster : monsters.second) {
-        if (monster.first == "basic")
-          enemy_type = Standard;
-        else if (monster.first == "fast")
-          enemy_type = Fast;
-        else if (monster.first == "big")
-          enemy_type = Big;
-        else if (monster.first == "magic")
-          enemy_type = Magic;
-        else if (monster.first == "boss")
-          enemy_type = Boss;
-        else {
-          enemy_type = Standard;
+// Searches outwards from the player base so every tile knows its distance to
+// the base and which tile to step to next. Enemies read their next step from
+// the tile they are on, so they don't need to be on the path to find the way.
+void Map::CalculateFlowField() {
+  const int width = GetWidth();
+  const int height = GetHeight();
+  distances_.assign(width * height, -1);
+  flow_field_.assign(width * height, -1);
+  std::queue<int> open_list;
+  int base = player_base_.second * width + player_base_.first;
+  distances_[base] = 0;
+  open_list.push(base);
+  while (!open_list.empty()) {
+    int index = open_list.front();
+    open_list.pop();
+    int x = index % width;
+    int y = index / width;
+    int neighbours[4];
+    int count = 0;
+    if (x > 0) neighbours[count++] = index - 1;
+    if (x < width - 1) neighbours[count++] = index + 1;
+    if (y > 0) neighbours[count++] = index - width;
+    if (y < height - 1) neighbours[count++] = index + width;
+    for (int i = 0; i < count; i++) {
+      int neighbour = neighbours[i];
+      if (distances_[neighbour] == -1 &&
+          IsTraversable(TileTypes(tiles_[neighbour]))) {
+        distances_[neighbour] = distances_[index] + 1;
+        open_list.push(neighbour);
+      }
+    }
+  }
+  for (int i = 0; i < width * height; i++) {
+    flow_field_[i] = GetNextTile(i);
+  }
+  // Where several routes are equally short, follow the path from the spawn
+  for (size_t i = 0; i + 1 < path_.size(); i++) {
+    flow_field_[path_[i].second * width + path_[i].first] =
+        path_[i + 1].second * width + path_[i + 1].first;
+  }
+}
+
+// Updates the distances and the flow field after SetTile, giving the same
+// result as CalculateFlowField. Tiles that lost their way to the base through
+// a blocked tile are cleared and searched again from the tiles around them,
+// together with the opened tiles. Only tiles whose distance changes and their
+// neighbours are visited.
+void Map::RepairFlowField(const std::vector<std::pair<int, int>>& old_path) {
+  const int width = GetWidth();
+  const int height = GetHeight();
+  const int base = player_base_.second * width + player_base_.first;
+  auto get_neighbours = [width, height](int index, int neighbours[4]) {
+    int x = index % width;
+    int y = index / width;
+    int count = 0;
+    if (x > 0) neighbours[count++] = index - 1;
+    if (x < width - 1) neighbours[count++] = index + 1;
+    if (y > 0) neighbours[count++] = index - width;
+    if (y < height - 1) neighbours[count++] = index + width;
+    return count;
+  };
+  auto traversable = [this](int index) {
+    return IsTraversable(TileTypes(tiles_[index]));
+  };
+
+  // Blocked tiles lose their distance. Going out from them one distance at a
+  // time, a tile whose next tile lost its distance keeps its own if another
+  // neighbour is still one step closer to the base, otherwise it is cleared
+  // too. Tiles keeping their distance only need a new next tile.
+  std::vector<std::pair<int, int>> blocked;
+  for (int index : changed_tiles_) {
+    if (index != base && !traversable(index) && distances_[index] != -1) {
+      blocked.push_back({distances_[index], index});
+    }
+  }
+  std::sort(blocked.begin(), blocked.end());
+  std::vector<int> cleared;
+  std::vector<int> redirected;
+  int neighbours[4];
+  int others[4];
+  size_t next_blocked = 0;
+  size_t level_begin = 0;
+  int level = 0;
+  while (next_blocked < blocked.size() || level_begin < cleared.size()) {
+    if (level_begin == cleared.size()) {
+      level = blocked[next_blocked].first;
+    }
+    for (; next_blocked < blocked.size() &&
+           blocked[next_blocked].first == level;
+         next_blocked++) {
+      int index = blocked[next_blocked].second;
+      if (distances_[index] != -1) {
+        distances_[index] = -1;
+        cleared.push_back(index);
+      }
+    }
+    size_t level_end = cleared.size();
+    for (size_t i = level_begin; i < level_end; i++) {
+      int count = get_neighbours(cleared[i], neighbours);
+      for (int j = 0; j < count; j++) {
+        int neighbour = neighbours[j];
+        if (distances_[neighbour] != level + 1 ||
+            flow_field_[neighbour] != cleared[i]) {
+          continue;
+        }
+        bool supported = false;
+        int other_count = get_neighbours(neighbour, others);
+        for (int k = 0; k < other_count; k++) {
+          supported = supported || distances_[others[k]] == level;
         }
-        for (int i = 0; i < monster.second.get<int>("amount"); i++) {
-          enemies.push_back(
-              Enemy(monster.second.get<int>("max_hp"),
-                    monster.second.get<float>("speed"),
-                    enemy_spawn_.first + 0.5, enemy_spawn_.second + 0.5,
-                    tile_size, monster.second.get<float>("delay"), enemy_type));
+        if (supported) {
+          redirected.push_back(neighbour);
+        } else {
+          distances_[neighbour] = -1;
+          cleared.push_back(neighbour);
         }
       }
     }
-  } catch (boost::property_tree::ptree_bad_path e) {
-    std::cout << "No such wave found" << std::endl;
+    level_begin = level_end;
+    level++;
   }
-  return enemies;
+
+  // Search outwards from the known distances at the border of the cleared
+  // and the opened tiles. Every step costs the same, so the search goes one
+  // distance at a time and adds the border tiles when it reaches theirs.
+  std::vector<std::pair<int, int>> border;
+  auto add_border = [&](int index) {
+    if (index == base) {
+      border.push_back({0, index});
+      return;
+    }
+    if (!traversable(index)) return;
+    int distance = -1;
+    int count = get_neighbours(index, neighbours);
+    for (int j = 0; j < count; j++) {
+      // Only the base and tiles the search reached have a distance
+      int neighbour = distances_[neighbours[j]];
+      if (neighbour != -1 && (distance == -1 || neighbour + 1 < distance)) {
+        distance = neighbour + 1;
+      }
+    }
+    if (distance != -1) border.push_back({distance, index});
+  };
+  for (int index : cleared) add_border(index);
+  for (int index : changed_tiles_) add_border(index);
+  std::sort(border.begin(), border.end());
+
+  // Every tile whose distance changed, the tiles at the current distance are
+  // at its end
+  std::vector<int> updated;
+  size_t next_border = 0;
+  level_begin = 0;
+  int distance = border.empty() ? 0 : border[0].first;
+  while (next_border < border.size() || level_begin < updated.size()) {
+    if (level_begin == updated.size()) {
+      distance = std::max(distance, border[next_border].first);
+    }
+    for (; next_border < border.size() &&
+           border[next_border].first == distance;
+         next_border++) {
+      int index = border[next_border].second;
+      if (distances_[index] == -1 || distances_[index] > distance) {
+        distances_[index] = distance;
+        updated.push_back(index);
+      }
+    }
+    size_t level_end = updated.size();
+    for (size_t i = level_begin; i < level_end; i++) {
+      int count = get_neighbours(updated[i], neighbours);
+      for (int j = 0; j < count; j++) {
+        int neighbour = neighbours[j];
+        if (traversable(neighbour) && (distances_[neighbour] == -1 ||
+                                       distances_[neighbour] > distance + 1)) {
+          distances_[neighbour] = distance + 1;
+          updated.push_back(neighbour);
+        }
+      }
+    }
+    level_begin = level_end;
+    distance++;
+  }
+
+  // The next tile depends on the distances of the neighbours, and the tiles
+  // of the old path lose the path's direction. Tiles to update are marked
+  // with -2 so each is only calculated once.
+  std::vector<int> dirty;
+  auto mark = [&](int index) {
+    if (flow_field_[index] != -2) {
+      flow_field_[index] = -2;
+      dirty.push_back(index);
+    }
+  };
+  auto mark_around = [&](int index) {
+    mark(index);
+    int count = get_neighbours(index, neighbours);
+    for (int j = 0; j < count; j++) mark(neighbours[j]);
+  };
+  for (int index : cleared) mark_around(index);
+  for (int index : updated) mark_around(index);
+  for (int index : changed_tiles_) mark_around(index);
+  for (int index : redirected) mark(index);
+  for (auto& tile : old_path) mark(tile.second * width + tile.first);
+  for (int index : dirty) flow_field_[index] = GetNextTile(index);
+  for (size_t i = 0; i + 1 < path_.size(); i++) {
+    flow_field_[path_[i].second * width + path_[i].first] =
+        path_[i + 1].second * width + path_[i + 1].first;
+  }
+}
+
+// The first neighbour one step closer to the base, -1 on the base and on
+// tiles it can't be reached from
+int Map::GetNextTile(int index) const {
+  const int width = GetWidth();
+  int distance = distances_[index];
+  if (distance <= 0) return -1;
+  int x = index % width;
+  int y = index / width;
+  int neighbours[4];
+  int count = 0;
+  if (x > 0) neighbours[count++] = index - 1;
+  if (x < width - 1) neighbours[count++] = index + 1;
+  if (y > 0) neighbours[count++] = index - width;
+  if (y < GetHeight() - 1) neighbours[count++] = index + width;
+  for (int i = 0; i < count; i++) {
+    if (distances_[neighbours[i]] == distance - 1) return neighbours[i];
+  }
+  return -1;
+}
+
+const std::vector<std::pair<int, int>>& Map::GetPath() const {
+  return path_;
 }
 
+// Returns the number of steps from the tile to the player base or -1 if the
+// base can't be reached from it
+int Map::GetDistance(const std::pair<int, int>& tile) const {
+  if (tile.first < 0 || tile.second < 0 || tile.first >= GetWidth() ||
+      tile.second >= GetHeight()) {
+    return -1;
+  }
+  return distances_[tile.second * GetWidth() + tile.first];
+}
+
+const std::vector<int>& Map::GetFlowField() const { return flow_field_; }
+
+// The waves of the map if it has any, otherwise those of the wave manager
+const WaveTable& Map::GetWaves() const {
+  return waves_.Empty() ? wave_manager.GetWaves() : waves_;
+}
+
+void Map::SetWaves(const WaveTable& waves) { waves_ = waves; }
+
 std::ostream& operator<<(std::ostream& os, const Map& map) {
-  for (auto row : map.GetTiles()) {
-    for (auto tile : row) {
-      os << tile;
+  for (int y = 0; y < map.GetHeight(); y++) {
+    for (int x = 0; x < map.GetWidth(); x++) {
+      os << int(map(x, y));
     }
     os << std::endl;
   }
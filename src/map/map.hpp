@@ -1,37 +1,62 @@
 #pragma once
-#include <SFML/Graphics.hpp>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <string>
 #include <vector>
 #include "../enemy/enemy.hpp"
+#include "incremental_pathfinder.hpp"
 #include "tile.hpp"
+#include "wave_table.hpp"
 
 class Map {
  public:
   Map();
   void Load(const std::string& filename);
-  void Draw(sf::RenderWindow& window);
+  void Load(std::istream& is);
+  bool LoadBundle(const std::string& file_path);
+  bool SaveBundle(const std::string& file_path) const;
   int GetWidth() const;
   int GetHeight() const;
   void SetName(const std::string& name);
-  std::string GetName();
-  const std::vector<std::vector<Tile>> GetTiles() const;
-  const Tile& operator()(int x, int y);
+  std::string GetName() const;
+  const std::vector<uint8_t>& GetTiles() const;
+  TileTypes operator()(int x, int y) const;
+  void SetTile(int x, int y, TileTypes type);
   const std::pair<int, int> GetEnemySpawn() const;
   const std::pair<int, int> GetPlayerBase() const;
+  // Returns false if the spawn can't reach the base, the map has no path
+  // then and the flow field leads only the tiles that still reach the base
   bool RecalculatePath();
-  std::vector<std::pair<int, int>> GetPath() const;
-  std::vector<Enemy> LoadWave(int wave);
-  int tile_size;
+  const std::vector<std::pair<int, int>>& GetPath() const;
+  int GetDistance(const std::pair<int, int>& tile) const;
+  const std::vector<int>& GetFlowField() const;
+  const WaveTable& GetWaves() const;
+  void SetWaves(const WaveTable& waves);
 
  private:
+  void CalculateFlowField();
+  void RepairFlowField(const std::vector<std::pair<int, int>>& old_path);
+  int GetNextTile(int index) const;
+
   std::string name_;
-  std::vector<std::vector<Tile>> tiles_;
+  int width_;
+  int height_;
+  // The tile types in row-major order
+  std::vector<uint8_t> tiles_;
 
   std::pair<int, int> enemy_spawn_;
   std::pair<int, int> player_base_;
   std::vector<std::pair<int, int>> path_;
+  // Steps from each tile to the player base, -1 if the base can't be reached
+  std::vector<int> distances_;
+  // Index of the tile to step to next from each tile, -1 if there is none
+  std::vector<int> flow_field_;
+  IncrementalPathfinder pathfinder_;
+  // Tiles changed by SetTile since the flow field was last updated
+  std::vector<int> changed_tiles_;
+  // Waves that came with the map, if empty the wave manager is used instead
+  WaveTable waves_;
 };
 
 std::ostream& operator<<(std::ostream& os, const Map& map);
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include "map_bundle.hpp"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <vector>
+#include "map.hpp"
+
+namespace MapBundle {
+namespace {
+const int TILE_TYPE_COUNT = Water3 + 1;
+const int ENEMY_TYPE_COUNT = Boss + 1;
+
+uint64_t Pad(uint64_t size) { return (size + 3) / 4 * 4; }
+
+template <typename T>
+void WriteValues(std::ofstream& os, const T* values, uint64_t count) {
+  os.write(reinterpret_cast<const char*>(values), count * sizeof(T));
+  const char padding[4] = {};
+  os.write(padding, Pad(count * sizeof(T)) - count * sizeof(T));
+}
+}  // namespace
+
+bool Write(const std::string& file_path, const Map& map) {
+  const WaveTable& waves = map.GetWaves();
+  Header header;
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.width = map.GetWidth();
+  header.height = map.GetHeight();
+  header.spawn_x = map.GetEnemySpawn().first;
+  header.spawn_y = map.GetEnemySpawn().second;
+  header.base_x = map.GetPlayerBase().first;
+  header.base_y = map.GetPlayerBase().second;
+  header.path_length = map.GetPath().size();
+  header.wave_count = waves.GetWaveCount();
+  header.group_count = waves.GetGroups().size();
+
+  std::vector<int32_t> path;
+  for (auto& tile : map.GetPath()) {
+    path.push_back(tile.first);
+    path.push_back(tile.second);
+  }
+  std::vector<int32_t> distances;
+  for (int y = 0; y < map.GetHeight(); y++) {
+    for (int x = 0; x < map.GetWidth(); x++) {
+      distances.push_back(map.GetDistance({x, y}));
+    }
+  }
+  std::vector<int32_t> wave_starts(waves.GetWaveStarts().begin(),
+                                   waves.GetWaveStarts().end());
+  std::vector<Group> groups;
+  for (auto& group : waves.GetGroups()) {
+    groups.push_back({group.type, group.amount, group.max_hp, group.speed,
+                      group.delay});
+  }
+
+  std::ofstream os(file_path, std::ios::binary);
+  if (!os.is_open()) {
+    std::cout << "Failed to open " << file_path << std::endl;
+    return false;
+  }
+  WriteValues(os, &header, 1);
+  WriteValues(os, map.GetTiles().data(), map.GetTiles().size());
+  WriteValues(os, path.data(), path.size());
+  WriteValues(os, distances.data(), distances.size());
+  WriteValues(os, map.GetFlowField().data(), map.GetFlowField().size());
+  WriteValues(os, wave_starts.data(), wave_starts.size());
+  WriteValues(os, groups.data(), groups.size());
+  return bool(os);
+}
+
+bool File::Open(const std::string& file_path) {
+  try {
+    file_.open(file_path);
+  } catch (std::exception& e) {
+    std::cout << "Failed to open " << file_path << std::endl;
+    return false;
+  }
+  if (file_.size() < sizeof(Header)) {
+    std::cout << file_path << " is not a map bundle" << std::endl;
+    return false;
+  }
+  header_ = reinterpret_cast<const Header*>(file_.data());
+  if (std::memcmp(header_->magic, MAGIC, sizeof(MAGIC)) != 0) {
+    std::cout << file_path << " is not a map bundle" << std::endl;
+    return false;
+  }
+  if (header_->version != VERSION) {
+    std::cout << file_path << " has bundle version " << header_->version
+              << ", expected " << VERSION << std::endl;
+    return false;
+  }
+  if (header_->width <= 0 || header_->height <= 0) {
+    std::cout << file_path << " has an invalid size" << std::endl;
+    return false;
+  }
+
+  // Find the sections and check that the file is as long as they need
+  uint64_t tile_count = uint64_t(header_->width) * header_->height;
+  uint64_t offset = Pad(sizeof(Header));
+  uint64_t tiles = offset;
+  offset += Pad(tile_count);
+  uint64_t path = offset;
+  offset += uint64_t(header_->path_length) * 2 * sizeof(int32_t);
+  uint64_t distances = offset;
+  offset += tile_count * sizeof(int32_t);
+  uint64_t flow_field = offset;
+  offset += tile_count * sizeof(int32_t);
+  uint64_t wave_starts = offset;
+  offset += uint64_t(header_->wave_count) * sizeof(int32_t);
+  uint64_t groups = offset;
+  offset += uint64_t(header_->group_count) * sizeof(Group);
+  if (offset != file_.size()) {
+    std::cout << file_path << " has the wrong size" << std::endl;
+    return false;
+  }
+  tiles_ = reinterpret_cast<const uint8_t*>(file_.data() + tiles);
+  path_ = reinterpret_cast<const int32_t*>(file_.data() + path);
+  distances_ = reinterpret_cast<const int32_t*>(file_.data() + distances);
+  flow_field_ = reinterpret_cast<const int32_t*>(file_.data() + flow_field);
+  wave_starts_ = reinterpret_cast<const int32_t*>(file_.data() + wave_starts);
+  groups_ = reinterpret_cast<const Group*>(file_.data() + groups);
+  if (!Validate()) {
+    std::cout << file_path << " contains invalid data" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Checks everything that is later used as an index
+bool File::Validate() const {
+  const int width = header_->width;
+  const int height = header_->height;
+  // Taken in 64 bits, the count has to fit the tile section and the int the
+  // map indexes its tiles with before it is used
+  const uint64_t tile_count = uint64_t(width) * uint64_t(height);
+  const uint64_t tile_section = reinterpret_cast<const char*>(path_) -
+                                reinterpret_cast<const char*>(tiles_);
+  if (tile_count > tile_section ||
+      tile_count > uint64_t(std::numeric_limits<int>::max())) {
+    return false;
+  }
+  auto in_map = [width, height](int x, int y) {
+    return x >= 0 && y >= 0 && x < width && y < height;
+  };
+  if (!in_map(header_->spawn_x, header_->spawn_y) ||
+      !in_map(header_->base_x, header_->base_y)) {
+    return false;
+  }
+  for (uint64_t i = 0; i < tile_count; i++) {
+    if (tiles_[i] >= TILE_TYPE_COUNT || distances_[i] < -1 ||
+        flow_field_[i] < -1 || flow_field_[i] >= int64_t(tile_count)) {
+      return false;
+    }
+  }
+  for (uint32_t i = 0; i < header_->path_length; i++) {
+    if (!in_map(path_[2 * i], path_[2 * i + 1])) return false;
+  }
+  for (uint32_t i = 0; i < header_->wave_count; i++) {
+    if (wave_starts_[i] < (i == 0 ? 0 : wave_starts_[i - 1]) ||
+        uint32_t(wave_starts_[i]) > header_->group_count) {
+      return false;
+    }
+  }
+  for (uint32_t i = 0; i < header_->group_count; i++) {
+    const Group& group = groups_[i];
+    if (group.type < 0 || group.type >= ENEMY_TYPE_COUNT ||
+        !IsValidGroup({EnemyTypes(group.type), group.amount, group.max_hp,
+                       group.speed, group.delay})) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const Header& File::GetHeader() const { return *header_; }
+const uint8_t* File::GetTiles() const { return tiles_; }
+const int32_t* File::GetPath() const { return path_; }
+const int32_t* File::GetDistances() const { return distances_; }
+const int32_t* File::GetFlowField() const { return flow_field_; }
+const int32_t* File::GetWaveStarts() const { return wave_starts_; }
+const Group* File::GetGroups() const { return groups_; }
+}  // namespace MapBundle
@@ -0,0 +1,74 @@
+#pragma once
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <cstdint>
+#include <string>
+
+class Map;
+
+// Binary map bundle: a map with its path, flow field and waves, ready to be
+// used without parsing or path finding. The file is a header followed by the
+// sections below, each padded to four bytes:
+//   tiles        width * height tile types, one byte each
+//   path         path_length (x, y) int32 pairs from the spawn to the base
+//   distances    width * height int32
+//   flow field   width * height int32
+//   wave starts  wave_count int32 indices of the first group of each wave
+//   groups       group_count records of int32 type and amount followed by
+//                float max_hp, speed and delay
+// All values are stored in the byte order of the machine that wrote them, a
+// bundle from a machine with another byte order is rejected by its magic.
+namespace MapBundle {
+const char MAGIC[4] = {'T', 'D', 'M', 'B'};
+// Increase when the layout changes, old bundles are then rejected
+const uint32_t VERSION = 1;
+
+struct Header {
+  char magic[4];
+  uint32_t version;
+  int32_t width;
+  int32_t height;
+  int32_t spawn_x;
+  int32_t spawn_y;
+  int32_t base_x;
+  int32_t base_y;
+  uint32_t path_length;
+  uint32_t wave_count;
+  uint32_t group_count;
+};
+
+struct Group {
+  int32_t type;
+  int32_t amount;
+  float max_hp;
+  float speed;
+  float delay;
+};
+
+bool Write(const std::string& file_path, const Map& map);
+
+// A bundle mapped into memory. The accessors point into the mapping and stay
+// valid while the file is open.
+class File {
+ public:
+  bool Open(const std::string& file_path);
+  const Header& GetHeader() const;
+  const uint8_t* GetTiles() const;
+  const int32_t* GetPath() const;
+  const int32_t* GetDistances() const;
+  const int32_t* GetFlowField() const;
+  const int32_t* GetWaveStarts() const;
+  const Group* GetGroups() const;
+
+ private:
+  bool Validate() const;
+
+  boost::iostreams::mapped_file_source file_;
+  const Header* header_;
+  const uint8_t* tiles_;
+  const int32_t* path_;
+  const int32_t* distances_;
+  const int32_t* flow_field_;
+  const int32_t* wave_starts_;
+  const Group* groups_;
+};
+}  // namespace MapBundle
@@ -1,133 +1,95 @@
 #include "pathfinder.hpp"
-#include <math.h>
+#include <stdlib.h>
 #include <algorithm>
-#include <array>
-#include <limits>
+#include <functional>
+#include <queue>
 
 namespace Pathfinder {
 
-bool operator<(const Node& l, const Node& r) { return l.f < r.f; }
-
-bool operator==(const Node& l, const Node& r) {
-  return (l.x == r.x && l.y == r.y);
-}
-
-std::ostream& operator<<(std::ostream& os, const Node& n) {
-  os << "(" << n.x << ", " << n.y << ")"
-     << "f:" << n.f << ", g:" << n.g << " h:" << n.h;
-  if (n.parent == nullptr) {
-  } else {
-    os << " " << (*(n.parent)).x << " " << (*(n.parent)).y << std::endl;
-  }
-  return os;
+// Order by f and prefer the node closer to the destination on ties
+bool operator>(const Node& l, const Node& r) {
+  if (l.f != r.f) return l.f > r.f;
+  return l.g < r.g;
 }
 
-// Converts the map to a grid of 0 and 1 based on if its traversable or not by
-// enemies
-const std::vector<std::vector<bool>> GetGrid(const Map map) {
-  std::vector<std::vector<bool>> grid;
-  int i = 0;
-  for (auto row : map.GetTiles()) {
-    grid.push_back(std::vector<bool>());
-    for (auto col : row) {
-      grid[i].push_back(IsTraversable(col.GetType()));
-    }
-    i++;
+// Converts the map to a row-major grid of 0 and 1 based on if its traversable
+// or not by enemies
+std::vector<unsigned char> GetGrid(const Map& map) {
+  const std::vector<uint8_t>& tiles = map.GetTiles();
+  std::vector<unsigned char> grid(tiles.size());
+  for (size_t i = 0; i < tiles.size(); i++) {
+    grid[i] = IsTraversable(TileTypes(tiles[i]));
   }
   return grid;
 }
 
-bool Exists(std::vector<Node> nodes, Node node) {
-  for (auto it = nodes.begin(); it != nodes.end(); it++) {
-    if ((*it) == node) return true;
-  }
-  return false;
-}
-
-// Get the path using A* search algorithm
-const std::vector<std::pair<int, int>> GetPath(const Map map) {
+// Get the path using A* search algorithm. The path is empty if there is none,
+// also when the spawn or the base is outside the map or not traversable.
+std::vector<std::pair<int, int>> GetPath(const Map& map) {
+  const int width = map.GetWidth();
+  const int height = map.GetHeight();
   auto grid = GetGrid(map);
 
   auto enemy_base = map.GetEnemySpawn();
   auto player_base = map.GetPlayerBase();
-
-  Node start;
-  start.x = enemy_base.first;
-  start.y = enemy_base.second;
-
-  Node dest;
-  dest.x = player_base.first;
-  dest.y = player_base.second;
-
-  std::vector<Node> open_list;
-  std::vector<Node> closed_list;
-
   std::vector<std::pair<int, int>> path;
-  std::vector<std::pair<int, int>> neighbour_offsets = {
-      {0, -1}, {0, 1}, {-1, 0}, {1, 0}};
-
-  open_list.push_back(start);
-  bool found = false;
+  auto is_open = [&](const std::pair<int, int>& tile) {
+    return tile.first >= 0 && tile.second >= 0 && tile.first < width &&
+           tile.second < height && grid[tile.second * width + tile.first];
+  };
+  if (!is_open(enemy_base) || !is_open(player_base)) return path;
+  const int start = enemy_base.second * width + enemy_base.first;
+  const int dest = player_base.second * width + player_base.first;
+
+  // Manhattan distance never overestimates on a grid without diagonal moves
+  auto heuristic = [&](int index) {
+    return abs(index % width - player_base.first) +
+           abs(index / width - player_base.second);
+  };
+
+  std::vector<int> g(grid.size(), -1);
+  std::vector<int> parent(grid.size(), -1);
+  std::vector<unsigned char> closed(grid.size(), 0);
+  std::priority_queue<Node, std::vector<Node>, std::greater<Node>> open_list;
+
+  g[start] = 0;
+  open_list.push({heuristic(start), 0, start});
 
   while (!open_list.empty()) {
-    if (!found) {
-      auto cur_node_it = std::min_element(open_list.begin(), open_list.end());
-      Node cur_node = *cur_node_it;
-      open_list.erase(cur_node_it);
+    Node cur = open_list.top();
+    open_list.pop();
+    // Skip outdated entries of nodes we already found a shorter way to
+    if (closed[cur.index]) continue;
+    closed[cur.index] = 1;
+
+    // Found a path to the destination tile
+    if (cur.index == dest) {
+      // Recreate the path by traversing the parents
+      for (int i = dest; i != -1; i = parent[i]) {
+        path.push_back({i % width, i / width});
+      }
+      std::reverse(path.begin(), path.end());
+      break;
+    }
 
-      if (!Exists(closed_list, cur_node)) {
-        closed_list.push_back(cur_node);
-        // Found a path to the destination tile
-        if ((cur_node) == dest) {
-          Node cur = cur_node;
-          // Recreate the path by traversing the parents
-          while (cur.parent != nullptr) {
-            path.push_back({cur.x, cur.y});
-            cur = *cur.parent;
-          }
-          found = true;
-        }
-        std::vector<Node> children;
-        // Add each neighbour to tiles to check
-        for (auto offset : neighbour_offsets) {
-          int x = cur_node.x + offset.first;
-          int y = cur_node.y + offset.second;
-          // Make sure neighbour is inside map
-          if (x < int(grid[0].size()) && x >= 0 && y < int(grid.size()) &&
-              y >= 0) {
-            // Check if neighbour tile is traversable
-            if (grid[y][x]) {
-              Node child;
-              child.x = x;
-              child.y = y;
-              child.parent = std::make_shared<Node>(cur_node);
-              children.push_back(child);
-            }
-          }
-        }
-        for (auto c = children.begin(); c != children.end(); c++) {
-          if (!Exists(closed_list, *c)) {
-            c->g = cur_node.g + 1;
-            c->h = sqrt(pow(c->x - dest.x, 2) + pow(c->y - dest.y, 2));
-            c->f = c->g + c->h;
-          }
-          bool f = false;
-          for (auto o : open_list) {
-            if (o == *c && c->g > o.g) {
-              f = true;
-            }
-          }
-          if (!f) {
-            open_list.push_back(*c);
-          }
-        }
+    int x = cur.index % width;
+    int y = cur.index / width;
+    const int neighbours[4][2] = {{0, -1}, {0, 1}, {-1, 0}, {1, 0}};
+    for (auto offset : neighbours) {
+      int nx = x + offset[0];
+      int ny = y + offset[1];
+      // Make sure neighbour is inside map and traversable
+      if (nx < 0 || ny < 0 || nx >= width || ny >= height) continue;
+      int next = ny * width + nx;
+      if (!grid[next] || closed[next]) continue;
+      int next_g = cur.g + 1;
+      if (g[next] == -1 || next_g < g[next]) {
+        g[next] = next_g;
+        parent[next] = cur.index;
+        open_list.push({next_g + heuristic(next), next_g, next});
       }
-    } else {
-      open_list.clear();
     }
   }
-  path.push_back({start.x, start.y});
-  std::reverse(path.begin(), path.end());
   return path;
 }
 
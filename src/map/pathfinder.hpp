@@ -1,23 +1,19 @@
 #pragma once
-#include <memory>
 #include <vector>
 #include "map.hpp"
 
 namespace Pathfinder {
+// Entry of the open list. Nodes are referred to by their index in the
+// row-major grid.
 struct Node {
-  int x, y;
-  float g = 0.0;
-  float h = 0.0;
-  float f = 0.0;
-  std::shared_ptr<Node> parent = nullptr;
+  int f;
+  int g;
+  int index;
 };
 
-bool operator<(const Node& l, const Node& r);
-bool operator==(const Node& l, const Node& r);
+bool operator>(const Node& l, const Node& r);
 
-const std::vector<std::vector<bool>> GetGrid(const Map map);
+std::vector<unsigned char> GetGrid(const Map& map);
 
-bool Exists(std::vector<Node> nodes, Node node);
-
-const std::vector<std::pair<int, int>> GetPath(const Map map);
+std::vector<std::pair<int, int>> GetPath(const Map& map);
 }  // namespace Pathfinder
@@ -1,8 +1,10 @@
 #pragma once
-#include <SFML/Graphics.hpp>
-#include <iostream>
+#include <cstdint>
+#include <string>
 
-enum TileTypes {
+// Maps store one byte per tile, the type. Everything needed to draw a tile
+// is looked up from the type.
+enum TileTypes : uint8_t {
   Path,
   Empty,
   Tree1,
@@ -15,22 +17,6 @@ enum TileTypes {
   Water3
 };
 
-class Tile : public sf::Drawable {
- public:
-  Tile(TileTypes type = Empty);
-  TileTypes GetType() const;
-  sf::Texture& GetTexture() const;
-  sf::Sprite* GetSprite();
-  void SetPosition(float x, float y);
-  void SetScale(float tile_size);
-
- private:
-  TileTypes type_;
-  std::string texturename_;
-  sf::Sprite sprite_;
-  virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const;
-};
+const std::string& GetTileTextureName(TileTypes type);
 
 bool IsTraversable(TileTypes type);
-
-std::ostream& operator<<(std::ostream& os, const Tile& tile);
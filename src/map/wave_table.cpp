@@ -0,0 +1,98 @@
+#include "wave_table.hpp"
+#include <string>
+
+namespace {
+bool GetEnemyType(const std::string& name, EnemyTypes& type) {
+  static const std::pair<const char*, EnemyTypes> types[] = {
+      {"basic", Standard}, {"fast", Fast}, {"big", Big},
+      {"magic", Magic},    {"boss", Boss}};
+  for (auto& entry : types) {
+    if (name == entry.first) {
+      type = entry.second;
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace
+
+bool IsValidGroup(const MonsterGroup& group) {
+  // Written so that NaN values fail too
+  return group.type >= Standard && group.type <= Boss && group.amount >= 0 &&
+         group.max_hp > 0 && group.speed > 0 && group.delay >= 0;
+}
+
+void WaveTable::Clear() {
+  groups_.clear();
+  wave_starts_.clear();
+}
+
+bool WaveTable::Empty() const { return wave_starts_.empty(); }
+
+bool WaveTable::Load(const boost::property_tree::ptree& waves,
+                     std::string& error_message) {
+  Clear();
+  // Waves are keyed "1", "2", ... without gaps
+  for (int wave = 1; wave <= int(waves.size()); wave++) {
+    std::string wave_name = "wave " + std::to_string(wave);
+    auto monsters = waves.get_child_optional(std::to_string(wave));
+    if (!monsters) {
+      error_message = wave_name + " is missing";
+      return false;
+    }
+    AddWave();
+    for (auto& group : *monsters) {
+      for (auto& monster : group.second) {
+        MonsterGroup monster_group;
+        std::string group_name = wave_name + " " + monster.first;
+        if (!GetEnemyType(monster.first, monster_group.type)) {
+          error_message = group_name + ": unknown monster type";
+          return false;
+        }
+        auto amount = monster.second.get_optional<int>("amount");
+        auto max_hp = monster.second.get_optional<int>("max_hp");
+        auto speed = monster.second.get_optional<float>("speed");
+        auto delay = monster.second.get_optional<float>("delay");
+        if (!amount || !max_hp || !speed || !delay) {
+          error_message =
+              group_name + ": amount, max_hp, speed and delay are required";
+          return false;
+        }
+        monster_group.amount = *amount;
+        monster_group.max_hp = *max_hp;
+        monster_group.speed = *speed;
+        monster_group.delay = *delay;
+        if (!IsValidGroup(monster_group)) {
+          error_message = group_name + ": values out of range";
+          return false;
+        }
+        AddGroup(monster_group);
+      }
+    }
+  }
+  return true;
+}
+
+void WaveTable::AddWave() { wave_starts_.push_back(groups_.size()); }
+
+void WaveTable::AddGroup(const MonsterGroup& group) {
+  groups_.push_back(group);
+}
+
+int WaveTable::GetWaveCount() const { return wave_starts_.size(); }
+
+int WaveTable::GetGroupsBegin(int wave) const {
+  return wave_starts_[wave - 1];
+}
+
+int WaveTable::GetGroupsEnd(int wave) const {
+  return wave < GetWaveCount() ? wave_starts_[wave] : groups_.size();
+}
+
+const std::vector<MonsterGroup>& WaveTable::GetGroups() const {
+  return groups_;
+}
+
+const std::vector<int>& WaveTable::GetWaveStarts() const {
+  return wave_starts_;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <boost/property_tree/ptree.hpp>
+#include <string>
+#include <vector>
+#include "../enemy/enemy.hpp"
+
+// A number of enemies of one type that spawn one after another
+struct MonsterGroup {
+  EnemyTypes type;
+  int amount;
+  float max_hp;
+  float speed;
+  float delay;
+};
+
+// Whether the values of a group are in range. Used wherever groups are read,
+// from waves.json, map bundles and saved games.
+bool IsValidGroup(const MonsterGroup& group);
+
+// The monster groups of all waves in one array, in the order they spawn
+class WaveTable {
+ public:
+  void Clear();
+  bool Empty() const;
+  // Reads the "waves" tree of a waves.json file. Returns false and describes
+  // the problem in error_message if anything is missing or invalid.
+  bool Load(const boost::property_tree::ptree& waves,
+            std::string& error_message);
+  // Starts a new wave, the following groups are added to it
+  void AddWave();
+  void AddGroup(const MonsterGroup& group);
+  int GetWaveCount() const;
+  // Waves are numbered from 1, the groups of wave n are in
+  // [GetGroupsBegin(n), GetGroupsEnd(n))
+  int GetGroupsBegin(int wave) const;
+  int GetGroupsEnd(int wave) const;
+  const std::vector<MonsterGroup>& GetGroups() const;
+  const std::vector<int>& GetWaveStarts() const;
+
+ private:
+  std::vector<MonsterGroup> groups_;
+  // Index of the first group of each wave
+  std::vector<int> wave_starts_;
+};
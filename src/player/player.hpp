@@ -1,3 +1,4 @@
+#pragma once
 #include <string>
 
 class Player {
@@ -10,7 +11,7 @@ class Player {
   void RemoveLives(int damage);
 
  private:
-  const std::string name_;
+  std::string name_;
   int lives_;
   int money_;
 };
@@ -0,0 +1,95 @@
+#include "profiler.hpp"
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+Profiler::Profiler()
+    : enabled_(false), next_event_(0), start_(Clock::now()) {}
+
+Profiler& Profiler::GetInstance() {
+  static Profiler instance;
+  return instance;
+}
+
+void Profiler::SetEnabled(bool enabled) { enabled_ = enabled; }
+
+int Profiler::GetSection(const std::string& name, Tracks track, bool counter) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t i = 0; i < sections_.size(); i++) {
+    if (sections_[i].name == name && sections_[i].track == track) return i;
+  }
+  sections_.push_back(
+      {name, track, counter, 0, std::vector<float>(HISTORY_SIZE), 0});
+  return sections_.size() - 1;
+}
+
+void Profiler::Record(int section, Clock::time_point begin,
+                      Clock::time_point end) {
+  int thread = GetThreadIndex();
+  std::lock_guard<std::mutex> lock(mutex_);
+  sections_[section].current +=
+      std::chrono::duration<double, std::micro>(end - begin).count();
+  Event event = {section, thread, begin, end};
+  if (trace_.size() < MAX_TRACE_EVENTS) {
+    trace_.push_back(event);
+  } else {
+    trace_[next_event_] = event;
+  }
+  next_event_ = (next_event_ + 1) % MAX_TRACE_EVENTS;
+}
+
+void Profiler::AddCount(int section, double amount) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  sections_[section].current += amount;
+}
+
+void Profiler::EndFrame(Tracks track) {
+  if (!IsEnabled()) return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& section : sections_) {
+    if (section.track != track) continue;
+    section.history[section.next] = section.current;
+    section.next = (section.next + 1) % HISTORY_SIZE;
+    section.current = 0;
+  }
+}
+
+std::vector<Profiler::Section> Profiler::GetSections() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return sections_;
+}
+
+bool Profiler::WriteTrace(const std::string& file_path) const {
+  std::ofstream os(file_path);
+  if (!os.is_open()) {
+    std::cout << "Failed to open " << file_path << std::endl;
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  os << std::fixed << std::setprecision(3) << "{\"traceEvents\": [";
+  // Oldest first, complete events with microsecond timestamps
+  size_t first = trace_.size() < MAX_TRACE_EVENTS ? 0 : next_event_;
+  for (size_t i = 0; i < trace_.size(); i++) {
+    const Event& event = trace_[(first + i) % trace_.size()];
+    const Section& section = sections_[event.section];
+    os << (i == 0 ? "\n" : ",\n") << "{\"name\": \"" << section.name
+       << "\", \"cat\": \"" << (section.track == Frame ? "frame" : "tick")
+       << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << event.thread
+       << ", \"ts\": "
+       << std::chrono::duration<double, std::micro>(event.begin - start_)
+              .count()
+       << ", \"dur\": "
+       << std::chrono::duration<double, std::micro>(event.end - event.begin)
+              .count()
+       << "}";
+  }
+  os << "\n]}\n";
+  return bool(os);
+}
+
+// Numbers the threads in the order they first record something
+int Profiler::GetThreadIndex() {
+  static std::atomic<int> thread_count(0);
+  thread_local int thread = ++thread_count;
+  return thread;
+}
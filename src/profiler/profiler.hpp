@@ -0,0 +1,112 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Measures how long the parts of a frame and of a simulation tick take.
+// Sections are timed with PROFILE_SCOPE and counted with PROFILE_COUNT, and
+// belong to the track of either the frames drawn by the main thread or the
+// ticks of the simulation thread. EndFrame adds what each section of a track
+// took since the last EndFrame to its rolling history.
+//
+// While the profiler is disabled a timer costs a single atomic load, and
+// without WITH_PROFILER the macros compile to nothing. The profiler is meant
+// for the game, simulations running side by side share its sections.
+class Profiler {
+ public:
+  typedef std::chrono::steady_clock Clock;
+  enum Tracks { Frame, Tick };
+  static const int HISTORY_SIZE = 120;
+  // The trace keeps the newest events
+  static const size_t MAX_TRACE_EVENTS = 1 << 16;
+
+  struct Section {
+    std::string name;
+    Tracks track;
+    // Counters add up amounts, timers microseconds
+    bool counter;
+    double current;
+    // The last HISTORY_SIZE frames of the track, history[next] is the oldest
+    std::vector<float> history;
+    int next;
+  };
+
+  static Profiler& GetInstance();
+  void SetEnabled(bool enabled);
+  bool IsEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+  // Returns the index of the section, adding it the first time
+  int GetSection(const std::string& name, Tracks track, bool counter = false);
+  void Record(int section, Clock::time_point begin, Clock::time_point end);
+  void AddCount(int section, double amount);
+  void EndFrame(Tracks track);
+  std::vector<Section> GetSections() const;
+  // Writes the timers recorded lately in the Chrome trace event format, which
+  // chrome://tracing and Perfetto open
+  bool WriteTrace(const std::string& file_path) const;
+
+  Profiler(Profiler const&) = delete;
+  void operator=(Profiler const&) = delete;
+
+ private:
+  struct Event {
+    int section;
+    int thread;
+    Clock::time_point begin;
+    Clock::time_point end;
+  };
+
+  Profiler();
+  static int GetThreadIndex();
+
+  std::atomic<bool> enabled_;
+  mutable std::mutex mutex_;
+  std::vector<Section> sections_;
+  std::vector<Event> trace_;
+  size_t next_event_;
+  Clock::time_point start_;
+};
+
+#define profiler Profiler::GetInstance()
+
+// Records the time from its construction to its destruction
+class ScopedTimer {
+ public:
+  explicit ScopedTimer(int section)
+      : section_(profiler.IsEnabled() ? section : -1) {
+    if (section_ != -1) begin_ = Profiler::Clock::now();
+  }
+  ~ScopedTimer() {
+    if (section_ != -1) {
+      profiler.Record(section_, begin_, Profiler::Clock::now());
+    }
+  }
+
+ private:
+  int section_;
+  Profiler::Clock::time_point begin_;
+};
+
+#ifdef WITH_PROFILER
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+// Times the rest of the enclosing scope, e.g. PROFILE_SCOPE(Frame, "Draw")
+#define PROFILE_SCOPE(track, name)                                       \
+  static const int PROFILE_CONCAT(profile_section_, __LINE__) =          \
+      profiler.GetSection(name, Profiler::track);                        \
+  ScopedTimer PROFILE_CONCAT(profile_timer_, __LINE__)(                  \
+      PROFILE_CONCAT(profile_section_, __LINE__))
+// Adds amount to a counter of the current frame of the track
+#define PROFILE_COUNT(track, name, amount)                               \
+  do {                                                                   \
+    if (profiler.IsEnabled()) {                                          \
+      static const int profile_section =                                 \
+          profiler.GetSection(name, Profiler::track, true);              \
+      profiler.AddCount(profile_section, amount);                        \
+    }                                                                    \
+  } while (false)
+#else
+#define PROFILE_SCOPE(track, name)
+#define PROFILE_COUNT(track, name, amount)
+#endif
@@ -0,0 +1,63 @@
+#include "enemy_grid.hpp"
+#include <math.h>
+#include <algorithm>
+
+EnemyGrid::EnemyGrid(int width, int height)
+    : width_(width), height_(height), first_(width * height, -1) {}
+
+void EnemyGrid::Rebuild(const EnemyStore& enemies) {
+  BeginRebuild(enemies);
+  FindTiles(enemies, 0, enemies.Size());
+  EndRebuild();
+}
+
+void EnemyGrid::BeginRebuild(const EnemyStore& enemies) {
+  // Only reset the tiles we used last time instead of the whole grid
+  for (int tile : occupied_) {
+    first_[tile] = -1;
+  }
+  occupied_.clear();
+  next_.assign(enemies.Size(), -1);
+  tiles_.resize(enemies.Size());
+}
+
+void EnemyGrid::FindTiles(const EnemyStore& enemies, int begin, int end) {
+  for (int i = begin; i < end; i++) {
+    auto position = enemies.GetTile(i);
+    if (!enemies.IsAlive(i) || position.first < 0 || position.second < 0 ||
+        position.first >= width_ || position.second >= height_) {
+      tiles_[i] = -1;
+    } else {
+      tiles_[i] = position.second * width_ + position.first;
+    }
+  }
+}
+
+// Links the enemies of each tile in the order of their index
+void EnemyGrid::EndRebuild() {
+  for (int i = int(tiles_.size()) - 1; i >= 0; i--) {
+    int tile = tiles_[i];
+    if (tile == -1) continue;
+    if (first_[tile] == -1) occupied_.push_back(tile);
+    next_[i] = first_[tile];
+    first_[tile] = i;
+  }
+}
+
+// Collects the indices of the enemies on tiles that overlap the bounding box
+// of the given circle. The caller still has to check the exact distance.
+void EnemyGrid::Query(float x, float y, float range,
+                      std::vector<int>& result) const {
+  result.clear();
+  int min_x = std::max(0, int(floor(x - range)));
+  int max_x = std::min(width_ - 1, int(floor(x + range)));
+  int min_y = std::max(0, int(floor(y - range)));
+  int max_y = std::min(height_ - 1, int(floor(y + range)));
+  for (int tile_y = min_y; tile_y <= max_y; tile_y++) {
+    for (int tile_x = min_x; tile_x <= max_x; tile_x++) {
+      for (int i = first_[tile_y * width_ + tile_x]; i != -1; i = next_[i]) {
+        result.push_back(i);
+      }
+    }
+  }
+}
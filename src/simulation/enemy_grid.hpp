@@ -0,0 +1,29 @@
+#pragma once
+#include <vector>
+#include "../enemy/enemy_store.hpp"
+
+// Buckets the live enemies by the tile they are on, so that a tower only has
+// to look at the enemies on the tiles its range covers.
+class EnemyGrid {
+ public:
+  EnemyGrid(int width = 0, int height = 0);
+  void Rebuild(const EnemyStore& enemies);
+  // Rebuild in three steps, FindTiles can run on disjoint ranges of enemies
+  // in parallel
+  void BeginRebuild(const EnemyStore& enemies);
+  void FindTiles(const EnemyStore& enemies, int begin, int end);
+  void EndRebuild();
+  void Query(float x, float y, float range, std::vector<int>& result) const;
+
+ private:
+  int width_;
+  int height_;
+  // Index of the first enemy on each tile, or -1 if the tile is empty
+  std::vector<int> first_;
+  // Index of the next enemy on the same tile, or -1
+  std::vector<int> next_;
+  // Tile of each enemy, or -1 if it is dead or off the map
+  std::vector<int> tiles_;
+  // Tiles that had enemies after the last rebuild
+  std::vector<int> occupied_;
+};
@@ -0,0 +1,103 @@
+#include "handle_pool.hpp"
+#include "save_game.hpp"
+
+bool operator==(const Handle& a, const Handle& b) {
+  return a.slot == b.slot && a.generation == b.generation;
+}
+
+bool operator!=(const Handle& a, const Handle& b) { return !(a == b); }
+
+void HandlePool::Reserve(int capacity) {
+  generations_.reserve(capacity);
+  indices_.reserve(capacity);
+  free_slots_.reserve(capacity);
+  slots_.reserve(capacity);
+}
+
+Handle HandlePool::Add() {
+  unsigned slot;
+  if (free_slots_.empty()) {
+    slot = generations_.size();
+    generations_.push_back(1);
+    indices_.push_back(-1);
+  } else {
+    slot = free_slots_.back();
+    free_slots_.pop_back();
+  }
+  indices_[slot] = slots_.size();
+  slots_.push_back(slot);
+  return {slot, generations_[slot]};
+}
+
+// Frees the slot of entity i and gives its index to the last entity
+void HandlePool::Remove(int i) {
+  unsigned slot = slots_[i];
+  unsigned last = slots_.back();
+  slots_[i] = last;
+  indices_[last] = i;
+  slots_.pop_back();
+
+  indices_[slot] = -1;
+  // Skip generation 0 when the counter wraps around
+  if (++generations_[slot] == 0) generations_[slot] = 1;
+  free_slots_.push_back(slot);
+}
+
+void HandlePool::Clear() {
+  while (!slots_.empty()) {
+    Remove(slots_.size() - 1);
+  }
+}
+
+int HandlePool::Size() const { return slots_.size(); }
+
+Handle HandlePool::GetHandle(int i) const {
+  return {slots_[i], generations_[slots_[i]]};
+}
+
+int HandlePool::GetIndex(const Handle& handle) const {
+  if (handle.slot >= generations_.size() ||
+      generations_[handle.slot] != handle.generation) {
+    return -1;
+  }
+  return indices_[handle.slot];
+}
+
+void HandlePool::Save(SaveGame::Writer& writer) const {
+  writer.WriteVector(generations_);
+  writer.WriteVector(indices_);
+  writer.WriteVector(free_slots_);
+  writer.WriteVector(slots_);
+}
+
+bool HandlePool::Load(SaveGame::Reader& reader) {
+  HandlePool pool;
+  if (!reader.ReadVector(pool.generations_) ||
+      !reader.ReadVector(pool.indices_) ||
+      !reader.ReadVector(pool.free_slots_) || !reader.ReadVector(pool.slots_) ||
+      pool.indices_.size() != pool.generations_.size() ||
+      pool.free_slots_.size() + pool.slots_.size() !=
+          pool.generations_.size()) {
+    return false;
+  }
+  // Every slot must be either used by the entity it points to or free once.
+  // Used slots are unique because each points back to a single entity.
+  for (size_t i = 0; i < pool.slots_.size(); i++) {
+    unsigned slot = pool.slots_[i];
+    if (slot >= pool.indices_.size() || pool.indices_[slot] != int(i)) {
+      return false;
+    }
+  }
+  std::vector<char> free(pool.indices_.size());
+  for (unsigned slot : pool.free_slots_) {
+    if (slot >= free.size() || free[slot] || pool.indices_[slot] != -1) {
+      return false;
+    }
+    free[slot] = true;
+  }
+  for (unsigned generation : pool.generations_) {
+    if (generation == 0) return false;
+  }
+  *this = std::move(pool);
+  return true;
+}
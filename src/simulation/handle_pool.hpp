@@ -0,0 +1,49 @@
+#pragma once
+#include <vector>
+
+namespace SaveGame {
+class Reader;
+class Writer;
+}  // namespace SaveGame
+
+// Refers to an entity in a HandlePool. A handle to a removed entity is stale
+// instead of dangling, even after its slot is reused by a new entity.
+struct Handle {
+  unsigned slot = 0;
+  // Generation 0 is never handed out, so a default handle is always stale
+  unsigned generation = 0;
+};
+
+bool operator==(const Handle& a, const Handle& b);
+bool operator!=(const Handle& a, const Handle& b);
+
+// Maps handles to the indices of entities in densely packed arrays, like the
+// ones of EnemyStore. The owner removes entities by moving the last one into
+// the gap and tells the pool to do the same. Slots of removed entities are
+// reused, so once the pool has reached its capacity adding and removing
+// entities doesn't allocate.
+class HandlePool {
+ public:
+  void Reserve(int capacity);
+  // Returns the handle of the entity appended at index Size()
+  Handle Add();
+  void Remove(int i);
+  void Clear();
+  int Size() const;
+  Handle GetHandle(int i) const;
+  // Returns the index of the entity or -1 if the handle is stale
+  int GetIndex(const Handle& handle) const;
+  // Saves the slots with their generations, so handles held elsewhere stay
+  // valid or stale after loading
+  void Save(SaveGame::Writer& writer) const;
+  // Returns false and leaves the pool unchanged if the data is invalid
+  bool Load(SaveGame::Reader& reader);
+
+ private:
+  // Per slot, the current generation and the index of its entity or -1
+  std::vector<unsigned> generations_;
+  std::vector<int> indices_;
+  std::vector<unsigned> free_slots_;
+  // Per entity index, the slot it occupies
+  std::vector<unsigned> slots_;
+};
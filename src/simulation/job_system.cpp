@@ -0,0 +1,104 @@
+#include "job_system.hpp"
+#include <algorithm>
+
+JobSystem::JobSystem(int threads)
+    : job_(nullptr), pending_(0), batch_(0), stop_(false) {
+  threads = std::max(1, threads);
+  for (int i = 0; i < threads; i++) {
+    queues_.emplace_back(new Queue());
+  }
+  // Thread 0 is the one calling ParallelFor
+  for (int i = 1; i < threads; i++) {
+    workers_.emplace_back(&JobSystem::RunWorker, this, i);
+  }
+}
+
+JobSystem::~JobSystem() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+int JobSystem::GetThreadCount() const { return queues_.size(); }
+
+void JobSystem::ParallelFor(int count, int grain,
+                            const std::function<void(int, int, int)>& job) {
+  grain = std::max(1, grain);
+  if (count <= 0) return;
+  if (workers_.empty() || count <= grain) {
+    job(0, count, 0);
+    return;
+  }
+
+  // Deal the chunks out round robin, stealing evens out the rest
+  job_ = &job;
+  int chunks = (count + grain - 1) / grain;
+  pending_ = chunks;
+  for (int i = 0; i < chunks; i++) {
+    Queue& queue = *queues_[i % queues_.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.chunks.push_back({i * grain, std::min(count, (i + 1) * grain)});
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    batch_++;
+  }
+  wake_.notify_all();
+
+  while (RunChunk(0)) {
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_.wait(lock, [this]() { return pending_ == 0; });
+}
+
+void JobSystem::RunWorker(int thread) {
+  unsigned batch = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [this, batch]() { return stop_ || batch_ != batch; });
+      if (stop_) return;
+      batch = batch_;
+    }
+    while (RunChunk(thread)) {
+    }
+  }
+}
+
+// Runs a chunk from the thread's own queue, or else steals the oldest chunk
+// of another thread. Returns false if there was nothing left to do.
+bool JobSystem::RunChunk(int thread) {
+  Chunk chunk;
+  bool found = false;
+  {
+    Queue& queue = *queues_[thread];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.chunks.empty()) {
+      chunk = queue.chunks.back();
+      queue.chunks.pop_back();
+      found = true;
+    }
+  }
+  for (size_t i = 1; !found && i < queues_.size(); i++) {
+    Queue& queue = *queues_[(thread + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.chunks.empty()) {
+      chunk = queue.chunks.front();
+      queue.chunks.pop_front();
+      found = true;
+    }
+  }
+  if (!found) return false;
+
+  (*job_)(chunk.begin, chunk.end, thread);
+  if (--pending_ == 0) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    done_.notify_all();
+  }
+  return true;
+}
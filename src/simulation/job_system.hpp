@@ -0,0 +1,53 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A pool of worker threads that split loops between them. Every thread has
+// its own queue of chunks and steals from the others once it runs out, so a
+// thread that got slow chunks doesn't hold up the rest.
+class JobSystem {
+ public:
+  // Starts threads - 1 workers, the thread calling ParallelFor is the last one
+  explicit JobSystem(int threads = std::thread::hardware_concurrency());
+  ~JobSystem();
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+  int GetThreadCount() const;
+  // Calls job(begin, end, thread) on chunks of at most grain items that cover
+  // [0, count) and returns once all of them are done. The thread index is
+  // below GetThreadCount() and no two chunks with the same index run at the
+  // same time, so it can pick per thread scratch space. Jobs must not call
+  // ParallelFor themselves.
+  void ParallelFor(int count, int grain,
+                   const std::function<void(int, int, int)>& job);
+
+ private:
+  struct Chunk {
+    int begin;
+    int end;
+  };
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Chunk> chunks;
+  };
+
+  void RunWorker(int thread);
+  bool RunChunk(int thread);
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> workers_;
+  const std::function<void(int, int, int)>* job_;
+  std::atomic<int> pending_;
+  // Guards batch_ and stop_, workers sleep until either changes
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  unsigned batch_;
+  bool stop_;
+};
@@ -0,0 +1,247 @@
+#include "replay.hpp"
+#include <cstring>
+#include <iostream>
+#include "../tower/tower_types.hpp"
+
+namespace Replay {
+namespace {
+void Hash(uint32_t& hash, uint32_t value) {
+  for (int i = 0; i < 4; i++) {
+    hash = (hash ^ ((value >> (8 * i)) & 0xff)) * 16777619u;
+  }
+}
+}  // namespace
+
+uint32_t HashMap(const Map& map) {
+  uint32_t hash = 2166136261u;
+  Hash(hash, map.GetWidth());
+  Hash(hash, map.GetHeight());
+  for (uint8_t tile : map.GetTiles()) {
+    Hash(hash, tile);
+  }
+  const WaveTable& waves = map.GetWaves();
+  for (int start : waves.GetWaveStarts()) {
+    Hash(hash, start);
+  }
+  for (auto& group : waves.GetGroups()) {
+    uint32_t max_hp, speed, delay;
+    std::memcpy(&max_hp, &group.max_hp, sizeof(max_hp));
+    std::memcpy(&speed, &group.speed, sizeof(speed));
+    std::memcpy(&delay, &group.delay, sizeof(delay));
+    Hash(hash, group.type);
+    Hash(hash, group.amount);
+    Hash(hash, max_hp);
+    Hash(hash, speed);
+    Hash(hash, delay);
+  }
+  return hash;
+}
+
+uint32_t HashTowers(const TowerTable& towers) {
+  uint32_t hash = 2166136261u;
+  for (int i = 0; i < TOWER_TYPE_COUNT; i++) {
+    Hash(hash, towers.GetPrice(TowerTypes(i)));
+    Hash(hash, towers.GetLevelCount(TowerTypes(i)));
+  }
+  for (auto& level : towers.GetLevels()) {
+    uint32_t range, damage, att_speed;
+    std::memcpy(&range, &level.range, sizeof(range));
+    std::memcpy(&damage, &level.damage, sizeof(damage));
+    std::memcpy(&att_speed, &level.att_speed, sizeof(att_speed));
+    Hash(hash, range);
+    Hash(hash, damage);
+    Hash(hash, att_speed);
+    Hash(hash, level.money_per_wave);
+    Hash(hash, level.upgrade_price);
+  }
+  return hash;
+}
+
+bool Apply(const Entry& entry, Simulation& simulation) {
+  switch (entry.type) {
+    case BuyTowerEntry:
+      return simulation.BuyTower(MakeTower(
+                 entry.tower, entry.position.first, entry.position.second,
+                 simulation.GetTowerTable())) != nullptr;
+    case UpgradeTowerEntry:
+      return simulation.UpgradeTower(entry.position);
+    case SellTowerEntry:
+      if (!simulation.GetTower(entry.position)) return false;
+      simulation.SellTower(entry.position);
+      return true;
+    case StartWaveEntry:
+      if (simulation.IsWaveActive()) return false;
+      simulation.StartWave();
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool Writer::Open(const std::string& file_path, const std::string& map_name,
+                  const Map& map, const TowerTable& towers,
+                  const Player& player) {
+  os_.open(file_path, std::ios::binary);
+  if (!os_.is_open()) {
+    std::cout << "Failed to open " << file_path << std::endl;
+    return false;
+  }
+  last_step_ = 0;
+  os_.write(MAGIC, sizeof(MAGIC));
+  WriteUint32(VERSION);
+  WriteVarint(map_name.size());
+  os_.write(map_name.data(), map_name.size());
+  WriteUint32(HashMap(map));
+  WriteUint32(HashTowers(towers));
+  WriteVarint(player.GetName().size());
+  os_.write(player.GetName().data(), player.GetName().size());
+  WriteVarint(player.GetLives());
+  WriteVarint(player.GetMoney());
+  return bool(os_);
+}
+
+bool Writer::IsOpen() const { return os_.is_open(); }
+
+void Writer::Write(const Entry& entry) {
+  WriteVarint(entry.step - last_step_);
+  last_step_ = entry.step;
+  os_.put(entry.type);
+  switch (entry.type) {
+    case BuyTowerEntry:
+      os_.put(entry.tower);
+      WriteVarint(entry.position.first);
+      WriteVarint(entry.position.second);
+      break;
+    case UpgradeTowerEntry:
+    case SellTowerEntry:
+      WriteVarint(entry.position.first);
+      WriteVarint(entry.position.second);
+      break;
+    case StateHashEntry:
+      WriteUint32(entry.hash);
+      break;
+    default:
+      break;
+  }
+}
+
+bool Writer::Close() {
+  if (!os_.is_open()) return false;
+  os_.close();
+  return bool(os_);
+}
+
+void Writer::WriteVarint(uint64_t value) {
+  while (value >= 0x80) {
+    os_.put(char((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  os_.put(char(value));
+}
+
+void Writer::WriteUint32(uint32_t value) {
+  for (int i = 0; i < 4; i++) {
+    os_.put(char(value >> (8 * i)));
+  }
+}
+
+bool Reader::Open(const std::string& file_path) {
+  is_.open(file_path, std::ios::binary);
+  if (!is_.is_open()) {
+    std::cout << "Failed to open " << file_path << std::endl;
+    return false;
+  }
+  last_step_ = 0;
+  broken_ = false;
+  char magic[sizeof(MAGIC)];
+  uint32_t version;
+  uint64_t lives, money;
+  if (!is_.read(magic, sizeof(magic)) ||
+      std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+    std::cout << file_path << ": Not a replay" << std::endl;
+    return false;
+  }
+  if (!ReadUint32(version) || version != VERSION) {
+    std::cout << file_path << ": Unsupported replay version" << std::endl;
+    return false;
+  }
+  if (!ReadString(map_name_) || !ReadUint32(map_hash_) ||
+      !ReadUint32(towers_hash_) || !ReadString(player_name_) ||
+      !ReadVarint(lives) || !ReadVarint(money)) {
+    std::cout << file_path << ": Broken header" << std::endl;
+    return false;
+  }
+  lives_ = lives;
+  money_ = money;
+  return true;
+}
+
+const std::string& Reader::GetMapName() const { return map_name_; }
+uint32_t Reader::GetMapHash() const { return map_hash_; }
+uint32_t Reader::GetTowersHash() const { return towers_hash_; }
+Player Reader::GetPlayer() const {
+  return Player(player_name_, lives_, money_);
+}
+
+bool Reader::Next(Entry& entry) {
+  // Running out of data between entries is the normal end
+  if (is_.peek() == EOF) return false;
+  broken_ = true;
+  uint64_t step;
+  if (!ReadVarint(step)) return false;
+  int type = is_.get();
+  if (type == EOF || type > StateHashEntry) return false;
+  last_step_ += step;
+  entry.step = last_step_;
+  entry.type = EntryTypes(type);
+  uint64_t x = 0, y = 0;
+  switch (entry.type) {
+    case BuyTowerEntry: {
+      int tower = is_.get();
+      if (tower == EOF || tower >= TOWER_TYPE_COUNT) return false;
+      entry.tower = TowerTypes(tower);
+      if (!ReadVarint(x) || !ReadVarint(y)) return false;
+      break;
+    }
+    case UpgradeTowerEntry:
+    case SellTowerEntry:
+      if (!ReadVarint(x) || !ReadVarint(y)) return false;
+      break;
+    case StateHashEntry:
+      if (!ReadUint32(entry.hash)) return false;
+      break;
+    default:
+      break;
+  }
+  entry.position = {int(x), int(y)};
+  broken_ = false;
+  return true;
+}
+
+bool Reader::IsBroken() const { return broken_; }
+
+bool Reader::ReadVarint(uint64_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    int byte = is_.get();
+    if (byte == EOF) return false;
+    value |= uint64_t(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) return true;
+  }
+  return false;
+}
+
+bool Reader::ReadUint32(uint32_t& value) {
+  unsigned char bytes[4];
+  if (!is_.read(reinterpret_cast<char*>(bytes), 4)) return false;
+  value = bytes[0] | bytes[1] << 8 | bytes[2] << 16 | uint32_t(bytes[3]) << 24;
+  return true;
+}
+
+bool Reader::ReadString(std::string& value) {
+  uint64_t size;
+  if (!ReadVarint(size) || size > 1024) return false;
+  value.resize(size);
+  return size == 0 || bool(is_.read(&value[0], size));
+}
+}  // namespace Replay
@@ -0,0 +1,105 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <utility>
+#include "../player/player.hpp"
+#include "../tower/tower_table.hpp"
+#include "simulation.hpp"
+
+// Binary log of the commands that changed a game, stamped with the step they
+// were given before. Replaying the log on the same map gives the same game,
+// which the state hashes in the log confirm step by step. Steps between waves
+// without a command are left without a hash.
+//
+// The file starts with a header:
+//   magic, version      4 bytes each
+//   map name            varint length and bytes
+//   map hash            uint32
+//   towers hash         uint32
+//   player name         varint length and bytes
+//   lives, money        varint each
+// followed by entries of a varint step, counted from the step of the entry
+// before, a type byte and the type's arguments:
+//   BuyTowerEntry       tower type byte, varint x and y
+//   UpgradeTowerEntry   varint x and y
+//   SellTowerEntry      varint x and y
+//   StartWaveEntry      nothing
+//   StateHashEntry      uint32 hash of the state after the step
+// Integers are little endian, varints use 7 bits per byte.
+namespace Replay {
+const char MAGIC[4] = {'T', 'D', 'R', 'P'};
+// Increase when the format or the simulation rules change, replays recorded
+// with other rules can't match
+const uint32_t VERSION = 2;
+
+enum EntryTypes : uint8_t {
+  BuyTowerEntry,
+  UpgradeTowerEntry,
+  SellTowerEntry,
+  StartWaveEntry,
+  StateHashEntry
+};
+
+struct Entry {
+  unsigned long step;
+  EntryTypes type;
+  TowerTypes tower;
+  std::pair<int, int> position;
+  uint32_t hash;
+};
+
+// Identifies the tiles and waves of a map
+uint32_t HashMap(const Map& map);
+// Identifies the prices and stats of the towers
+uint32_t HashTowers(const TowerTable& towers);
+// Gives the command of the entry to the simulation, returns false if the
+// simulation refused it
+bool Apply(const Entry& entry, Simulation& simulation);
+
+class Writer {
+ public:
+  bool Open(const std::string& file_path, const std::string& map_name,
+            const Map& map, const TowerTable& towers, const Player& player);
+  bool IsOpen() const;
+  void Write(const Entry& entry);
+  // Returns false if anything failed to be written
+  bool Close();
+
+ private:
+  void WriteVarint(uint64_t value);
+  void WriteUint32(uint32_t value);
+
+  std::ofstream os_;
+  unsigned long last_step_ = 0;
+};
+
+class Reader {
+ public:
+  bool Open(const std::string& file_path);
+  const std::string& GetMapName() const;
+  uint32_t GetMapHash() const;
+  uint32_t GetTowersHash() const;
+  // A player as the game started with
+  Player GetPlayer() const;
+  // Reads the next entry, returns false at the end of the log or if the
+  // entry is broken
+  bool Next(Entry& entry);
+  bool IsBroken() const;
+
+ private:
+  bool ReadVarint(uint64_t& value);
+  bool ReadUint32(uint32_t& value);
+  bool ReadString(std::string& value);
+
+  std::ifstream is_;
+  std::string map_name_;
+  uint32_t map_hash_ = 0;
+  uint32_t towers_hash_ = 0;
+  std::string player_name_;
+  int lives_ = 0;
+  int money_ = 0;
+  unsigned long last_step_ = 0;
+  bool broken_ = false;
+};
+}  // namespace Replay
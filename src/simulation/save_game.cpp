@@ -0,0 +1,129 @@
+#include "save_game.hpp"
+#include <fstream>
+#include <iostream>
+#include "replay.hpp"
+#include "simulation.hpp"
+
+namespace SaveGame {
+void Writer::WriteString(const std::string& value) {
+  Write(uint32_t(value.size()));
+  data_.append(value);
+}
+
+void Writer::Reserve(size_t size) { data_.reserve(data_.size() + size); }
+
+const std::string& Writer::GetData() const { return data_; }
+
+bool Writer::WriteFile(const std::string& file_path) const {
+  std::ofstream os(file_path, std::ios::binary);
+  if (!os.is_open()) {
+    std::cout << "Failed to open " << file_path << std::endl;
+    return false;
+  }
+  os.write(data_.data(), data_.size());
+  return bool(os);
+}
+
+Reader::Reader(std::string data)
+    : data_(std::move(data)), offset_(0), failed_(false) {}
+
+bool Reader::ReadFile(const std::string& file_path) {
+  std::ifstream is(file_path, std::ios::binary | std::ios::ate);
+  if (!is.is_open()) {
+    std::cout << "Failed to open " << file_path << std::endl;
+    return false;
+  }
+  data_.resize(is.tellg());
+  is.seekg(0);
+  Rewind();
+  return data_.empty() || bool(is.read(&data_[0], data_.size()));
+}
+
+bool Reader::ReadString(std::string& value) {
+  uint32_t size;
+  if (!Read(size) || !Take(size)) return false;
+  value.assign(data_, offset_ - size, size);
+  return true;
+}
+
+bool Reader::AtEnd() const { return !failed_ && offset_ == data_.size(); }
+
+void Reader::Rewind() {
+  offset_ = 0;
+  failed_ = false;
+}
+
+bool Reader::Take(uint64_t size) {
+  if (failed_ || size > data_.size() - offset_) {
+    failed_ = true;
+    return false;
+  }
+  offset_ += size;
+  return true;
+}
+
+void Save(const std::string& map_name, const Simulation& simulation,
+          Writer& writer) {
+  writer.Write(MAGIC);
+  writer.Write(VERSION);
+  writer.WriteString(map_name);
+  writer.Write(Replay::HashMap(simulation.GetMap()));
+  writer.Write(Replay::HashTowers(simulation.GetTowerTable()));
+  simulation.Save(writer);
+}
+
+bool Save(const std::string& file_path, const std::string& map_name,
+          const Simulation& simulation) {
+  Writer writer;
+  Save(map_name, simulation, writer);
+  return writer.WriteFile(file_path);
+}
+
+bool ReadHeader(Reader& reader, std::string& map_name, uint32_t& map_hash,
+                uint32_t& towers_hash) {
+  char magic[sizeof(MAGIC)];
+  uint32_t version;
+  reader.Rewind();
+  if (!reader.Read(magic) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+    std::cout << "Not a saved game" << std::endl;
+    return false;
+  }
+  if (!reader.Read(version) || version != VERSION) {
+    std::cout << "Unsupported save version" << std::endl;
+    return false;
+  }
+  if (!reader.ReadString(map_name) || !reader.Read(map_hash) ||
+      !reader.Read(towers_hash)) {
+    std::cout << "Broken save header" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool Load(Reader& reader, Simulation& simulation) {
+  std::string map_name;
+  uint32_t map_hash, towers_hash;
+  if (!ReadHeader(reader, map_name, map_hash, towers_hash)) {
+    return false;
+  }
+  if (map_hash != Replay::HashMap(simulation.GetMap())) {
+    std::cout << "The game was saved on another map than " << map_name
+              << std::endl;
+    return false;
+  }
+  if (towers_hash != Replay::HashTowers(simulation.GetTowerTable())) {
+    std::cout << "The game was saved with other tower stats" << std::endl;
+    return false;
+  }
+  if (!simulation.Load(reader)) {
+    std::cout << "Broken saved game" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool Load(const std::string& file_path, Simulation& simulation) {
+  Reader reader;
+  return reader.ReadFile(file_path) && Load(reader, simulation);
+}
+}  // namespace SaveGame
@@ -0,0 +1,109 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+class Simulation;
+
+// Binary snapshot of a running game: the towers with their upgrades, the
+// enemies on the field, the spawn queue, the player and the wave counter.
+// Loading it on the same map with the same tower stats continues the game
+// exactly where it was saved, so it can be used for quick saves or to branch
+// off several games.
+//
+// The file starts with a header:
+//   magic, version      4 bytes each
+//   map name            uint32 length and bytes
+//   map hash            uint32, see Replay::HashMap
+//   towers hash         uint32, see Replay::HashTowers
+// followed by the state written by Simulation::Save. Arrays are stored as a
+// uint32 length and their elements copied byte by byte, in the byte order of
+// the machine that wrote them like map bundles.
+namespace SaveGame {
+const char MAGIC[4] = {'T', 'D', 'S', 'G'};
+// Increase when the layout of the state changes, old saves are then rejected
+const uint32_t VERSION = 2;
+
+// Collects the state in memory, so a snapshot can be kept without a file
+class Writer {
+ public:
+  template <typename T>
+  void Write(const T& value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Only plain values can be written");
+    data_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+  template <typename T>
+  void WriteVector(const std::vector<T>& values) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Only plain values can be written");
+    Write(uint32_t(values.size()));
+    data_.append(reinterpret_cast<const char*>(values.data()),
+                 values.size() * sizeof(T));
+  }
+  void WriteString(const std::string& value);
+  // Makes room for size more bytes, so that large arrays are copied once
+  void Reserve(size_t size);
+  const std::string& GetData() const;
+  bool WriteFile(const std::string& file_path) const;
+
+ private:
+  std::string data_;
+};
+
+// Reads back what a Writer wrote. Reads fail instead of running past the
+// end, and once one failed all following ones do.
+class Reader {
+ public:
+  explicit Reader(std::string data = "");
+  bool ReadFile(const std::string& file_path);
+  template <typename T>
+  bool Read(T& value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Only plain values can be read");
+    if (!Take(sizeof(T))) return false;
+    std::memcpy(&value, data_.data() + offset_ - sizeof(T), sizeof(T));
+    return true;
+  }
+  template <typename T>
+  bool ReadVector(std::vector<T>& values) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Only plain values can be read");
+    uint32_t size;
+    if (!Read(size) || !Take(uint64_t(size) * sizeof(T))) return false;
+    values.resize(size);
+    if (size > 0) {
+      std::memcpy(&values[0], data_.data() + offset_ - size * sizeof(T),
+                  size * sizeof(T));
+    }
+    return true;
+  }
+  bool ReadString(std::string& value);
+  bool AtEnd() const;
+  // Goes back to the start of the data
+  void Rewind();
+
+ private:
+  bool Take(uint64_t size);
+
+  std::string data_;
+  size_t offset_;
+  bool failed_;
+};
+
+// Saves the game to memory. map_name is stored so the game can find the map
+// again before loading.
+void Save(const std::string& map_name, const Simulation& simulation,
+          Writer& writer);
+bool Save(const std::string& file_path, const std::string& map_name,
+          const Simulation& simulation);
+// Reads the header from the start of the data, e.g. to find the map to load
+bool ReadHeader(Reader& reader, std::string& map_name, uint32_t& map_hash,
+                uint32_t& towers_hash);
+// Loads a game saved on the map of the simulation with the current tower
+// stats. On failure the simulation keeps its state.
+bool Load(Reader& reader, Simulation& simulation);
+bool Load(const std::string& file_path, Simulation& simulation);
+}  // namespace SaveGame
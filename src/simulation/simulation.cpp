@@ -0,0 +1,419 @@
+#include "simulation.hpp"
+#include <math.h>
+#include <cstring>
+#include "../profiler/profiler.hpp"
+#include "../tower/tower_types.hpp"
+
+namespace {
+// FNV-1a over the bytes of the value
+template <typename T>
+void Hash(uint32_t& hash, const T& value) {
+  unsigned char bytes[sizeof(T)];
+  std::memcpy(bytes, &value, sizeof(T));
+  for (unsigned char byte : bytes) {
+    hash = (hash ^ byte) * 16777619u;
+  }
+}
+
+// A tower in a saved game, the 64 bit field first so there is no padding
+struct SavedTower {
+  uint64_t last_attack;
+  int32_t x, y;
+  uint32_t type;
+  int32_t upgrade;
+  uint32_t target_slot, target_generation;
+};
+}  // namespace
+
+Simulation::Simulation(const Map& map, const Player& player,
+                       const TowerTable& towers)
+    : map_(map),
+      tower_table_(towers),
+      enemy_grid_(map.GetWidth(), map.GetHeight()),
+      jobs_(nullptr),
+      in_range_(1),
+      next_group_(0),
+      group_spawned_(0),
+      enemies_to_spawn_(0),
+      player_(player),
+      step_(0),
+      last_spawn_(0),
+      wave_(0),
+      wave_active_(false),
+      money_per_wave_(50) {}
+
+void Simulation::SetJobSystem(JobSystem* jobs) {
+  jobs_ = jobs;
+  in_range_.resize(jobs_ ? jobs_->GetThreadCount() : 1);
+}
+
+void Simulation::Step() {
+  step_++;
+  MoveEnemies();
+  FindEnemies();
+  SpawnEnemies();
+
+  // Pay out the wave bonus once the last enemy of the wave is gone
+  if (wave_active_ && enemies_.Empty() && enemies_to_spawn_ == 0) {
+    wave_active_ = false;
+    player_.AddMoney(money_per_wave_);
+    money_per_wave_ += 50;
+  }
+}
+
+void Simulation::StartWave() {
+  if (wave_active_) return;
+  wave_++;
+  spawn_queue_.clear();
+  next_group_ = 0;
+  group_spawned_ = 0;
+  enemies_to_spawn_ = 0;
+  const WaveTable& waves = map_.GetWaves();
+  if (wave_ <= waves.GetWaveCount()) {
+    auto groups = waves.GetGroups().begin();
+    spawn_queue_.assign(groups + waves.GetGroupsBegin(wave_),
+                        groups + waves.GetGroupsEnd(wave_));
+  }
+  for (auto& group : spawn_queue_) {
+    enemies_to_spawn_ += group.amount;
+  }
+  // Make room for the whole wave, so spawning doesn't allocate
+  enemies_.Reserve(enemies_.Size() + enemies_to_spawn_);
+  wave_active_ = true;
+}
+
+Tower* Simulation::BuyTower(std::unique_ptr<Tower> tower) {
+  auto position = tower->GetPosition();
+  if (!CanPlaceTower(tower->GetType(), map_, position.first,
+                     position.second) ||
+      player_.GetMoney() < tower->GetPrice() || towers_.count(position)) {
+    return nullptr;
+  }
+  player_.AddMoney(-tower->GetPrice());
+  money_per_wave_ += tower->GetMoneyPerWave();
+  return towers_.emplace(position, std::move(tower)).first->second.get();
+}
+
+bool Simulation::UpgradeTower(const std::pair<int, int>& position) {
+  Tower* tower = GetTower(position);
+  if (tower == nullptr || !tower->IsUpgradeable() ||
+      player_.GetMoney() < tower->GetUpgradePrice()) {
+    return false;
+  }
+  player_.AddMoney(-tower->GetUpgradePrice());
+  int current = tower->GetMoneyPerWave();
+  tower->Upgrade();
+  money_per_wave_ += tower->GetMoneyPerWave() - current;
+  return true;
+}
+
+void Simulation::SellTower(const std::pair<int, int>& position) {
+  Tower* tower = GetTower(position);
+  if (tower == nullptr) return;
+  player_.AddMoney(tower->GetPrice() / 2);
+  towers_.erase(position);
+}
+
+Tower* Simulation::GetTower(const std::pair<int, int>& position) {
+  auto tower = towers_.find(position);
+  if (tower == towers_.end()) return nullptr;
+  return tower->second.get();
+}
+
+const std::map<std::pair<int, int>, std::unique_ptr<Tower>>&
+Simulation::GetTowers() const {
+  return towers_;
+}
+
+const EnemyStore& Simulation::GetEnemies() const { return enemies_; }
+
+int Simulation::GetEnemiesRemaining() const {
+  int alive = 0;
+  for (int i = 0; i < enemies_.Size(); i++) {
+    if (enemies_.IsAlive(i)) alive++;
+  }
+  return alive + enemies_to_spawn_;
+}
+
+const Map& Simulation::GetMap() const { return map_; }
+const TowerTable& Simulation::GetTowerTable() const { return tower_table_; }
+const Player& Simulation::GetPlayer() const { return player_; }
+int Simulation::GetWave() const { return wave_; }
+bool Simulation::IsWaveActive() const { return wave_active_; }
+bool Simulation::IsGameOver() const { return player_.GetLives() <= 0; }
+unsigned long Simulation::GetStep() const { return step_; }
+
+uint32_t Simulation::GetStateHash() const {
+  uint32_t hash = 2166136261u;
+  Hash(hash, step_);
+  Hash(hash, wave_);
+  Hash(hash, wave_active_);
+  Hash(hash, player_.GetMoney());
+  Hash(hash, player_.GetLives());
+  Hash(hash, money_per_wave_);
+  Hash(hash, enemies_to_spawn_);
+  Hash(hash, last_spawn_);
+  for (int i = 0; i < enemies_.Size(); i++) {
+    Hash(hash, enemies_.GetId(i));
+    Hash(hash, enemies_.GetPosition(i));
+    Hash(hash, enemies_.GetHp(i));
+  }
+  for (auto& tower : towers_) {
+    Hash(hash, tower.first);
+    Hash(hash, tower.second->GetType());
+    Hash(hash, tower.second->GetCurrentUpgrade());
+    Hash(hash, tower.second->GetLastAttack());
+  }
+  return hash;
+}
+
+void Simulation::Save(SaveGame::Writer& writer) const {
+  writer.Write(uint64_t(step_));
+  writer.Write(int32_t(wave_));
+  writer.Write(uint8_t(wave_active_));
+  writer.Write(int32_t(money_per_wave_));
+  writer.WriteString(player_.GetName());
+  writer.Write(int32_t(player_.GetLives()));
+  writer.Write(int32_t(player_.GetMoney()));
+
+  writer.WriteVector(spawn_queue_);
+  writer.Write(uint64_t(next_group_));
+  writer.Write(int32_t(group_spawned_));
+  writer.Write(int32_t(enemies_to_spawn_));
+  writer.Write(uint64_t(last_spawn_));
+
+  std::vector<SavedTower> towers;
+  towers.reserve(towers_.size());
+  for (auto& tower : towers_) {
+    Handle target = tower.second->GetTarget();
+    towers.push_back({tower.second->GetLastAttack(), tower.first.first,
+                      tower.first.second, tower.second->GetType(),
+                      tower.second->GetCurrentUpgrade(), target.slot,
+                      target.generation});
+  }
+  writer.WriteVector(towers);
+  enemies_.Save(writer);
+}
+
+bool Simulation::Load(SaveGame::Reader& reader) {
+  uint64_t step, next_group, last_spawn;
+  int32_t wave, money_per_wave, lives, money, group_spawned, enemies_to_spawn;
+  uint8_t wave_active;
+  std::string player_name;
+  std::vector<MonsterGroup> spawn_queue;
+  std::vector<SavedTower> saved_towers;
+  EnemyStore enemies;
+  if (!reader.Read(step) || !reader.Read(wave) || !reader.Read(wave_active) ||
+      !reader.Read(money_per_wave) || !reader.ReadString(player_name) ||
+      !reader.Read(lives) || !reader.Read(money) ||
+      !reader.ReadVector(spawn_queue) || !reader.Read(next_group) ||
+      !reader.Read(group_spawned) || !reader.Read(enemies_to_spawn) ||
+      !reader.Read(last_spawn) || !reader.ReadVector(saved_towers) ||
+      !enemies.Load(reader, map_) || !reader.AtEnd()) {
+    return false;
+  }
+  if (next_group > spawn_queue.size() || last_spawn > step) {
+    return false;
+  }
+  for (auto& group : spawn_queue) {
+    if (!IsValidGroup(group)) return false;
+  }
+  // The spawn counters must match the queue like SpawnEnemies leaves them
+  int64_t left = 0;
+  for (size_t i = next_group; i < spawn_queue.size(); i++) {
+    left += spawn_queue[i].amount;
+  }
+  int max_spawned =
+      next_group < spawn_queue.size() ? spawn_queue[next_group].amount : 0;
+  if (group_spawned < 0 || group_spawned > max_spawned ||
+      enemies_to_spawn != left - group_spawned) {
+    return false;
+  }
+
+  // Towers are built anew and upgraded to their saved level
+  std::map<std::pair<int, int>, std::unique_ptr<Tower>> towers;
+  for (auto& saved : saved_towers) {
+    if (saved.type >= TOWER_TYPE_COUNT ||
+        !CanPlaceTower(TowerTypes(saved.type), map_, saved.x, saved.y) ||
+        towers.count({saved.x, saved.y}) || saved.last_attack > step) {
+      return false;
+    }
+    auto tower =
+        MakeTower(TowerTypes(saved.type), saved.x, saved.y, tower_table_);
+    while (tower->GetCurrentUpgrade() < saved.upgrade &&
+           tower->IsUpgradeable()) {
+      tower->Upgrade();
+    }
+    if (tower->GetCurrentUpgrade() != saved.upgrade) return false;
+    tower->SetLastAttack(saved.last_attack);
+    tower->SetTarget({saved.target_slot, saved.target_generation});
+    towers[{saved.x, saved.y}] = std::move(tower);
+  }
+
+  step_ = step;
+  wave_ = wave;
+  wave_active_ = wave_active;
+  money_per_wave_ = money_per_wave;
+  player_ = Player(player_name, lives, money);
+  spawn_queue_ = std::move(spawn_queue);
+  next_group_ = next_group;
+  group_spawned_ = group_spawned;
+  enemies_to_spawn_ = enemies_to_spawn;
+  last_spawn_ = last_spawn;
+  towers_ = std::move(towers);
+  enemies_ = std::move(enemies);
+  // Make room for the rest of the wave like StartWave does
+  enemies_.Reserve(enemies_.Size() + enemies_to_spawn_);
+  return true;
+}
+
+void Simulation::MoveEnemies() {
+  PROFILE_SCOPE(Tick, "MoveEnemies");
+  // Remove the enemies that died during the last step
+  for (int i = 0; i < enemies_.Size();) {
+    if (enemies_.IsAlive(i)) {
+      i++;
+    } else {
+      enemies_.Remove(i);
+    }
+  }
+
+  ParallelFor(enemies_.Size(), 4096, [this](int begin, int end, int) {
+    enemies_.Move(map_, begin, end);
+  });
+
+  auto player_base = map_.GetPlayerBase();
+  for (int i = 0; i < enemies_.Size(); i++) {
+    if (enemies_.GetTile(i) == player_base) {
+      enemies_.SetHp(i, 0);
+      if (player_.GetLives() > 0) {
+        player_.RemoveLives(1);
+      }
+    }
+  }
+}
+
+void Simulation::FindEnemies() {
+  PROFILE_SCOPE(Tick, "FindEnemies");
+  SelectTargets();
+
+  // Attack in tower order like a single thread would. If an earlier tower
+  // killed the chosen enemy the tower chooses again among the ones left.
+  for (size_t i = 0; i < ready_towers_.size(); i++) {
+    Tower* tower = ready_towers_[i];
+    int target = targets_[i];
+    if (target != -1 && !enemies_.IsAlive(target)) {
+      target = SelectTarget(*tower, in_range_[0]);
+    }
+    if (target != -1) {
+      tower->SetLastAttack(step_);
+      tower->SetTarget(enemies_.GetHandle(target));
+      bool dead = tower->Attack(enemies_, target);
+      if (dead) {
+        player_.AddMoney(GetReward(enemies_.GetType(target)));
+      }
+    }
+  }
+}
+
+// Finds the towers that can attack in this step and the enemy each of them
+// chooses, nothing is changed yet
+void Simulation::SelectTargets() {
+  enemy_grid_.BeginRebuild(enemies_);
+  ParallelFor(enemies_.Size(), 4096, [this](int begin, int end, int) {
+    enemy_grid_.FindTiles(enemies_, begin, end);
+  });
+  enemy_grid_.EndRebuild();
+
+  ready_towers_.clear();
+  for (auto& tower : towers_) {
+    if (tower.second->GetDefinition().targeting == TargetNone) continue;
+    // Steps between attacks, as double so that long games compare exactly
+    double cooldown = STEPS_PER_SECOND / double(tower.second->GetAttSpeed());
+    if (step_ - tower.second->GetLastAttack() > cooldown) {
+      ready_towers_.push_back(tower.second.get());
+    }
+  }
+  // Every tower chooses its target on its own, based on the enemies as they
+  // were at the start of the attacks
+  targets_.resize(ready_towers_.size());
+  ParallelFor(ready_towers_.size(), 16, [this](int begin, int end,
+                                               int thread) {
+    for (int i = begin; i < end; i++) {
+      targets_[i] = SelectTarget(*ready_towers_[i], in_range_[thread]);
+    }
+  });
+}
+
+// Returns the enemy in range that is closest to the player base, enemies still
+// on the spawn are left alone. Ties go to the enemy that spawned first.
+int Simulation::SelectTarget(const Tower& tower,
+                             std::vector<int>& in_range) const {
+  float range = tower.GetRange();
+  auto tower_pos = tower.GetPosition();
+  int target = -1;
+  int shortest_distance = map_.GetDistance(map_.GetEnemySpawn());
+  enemy_grid_.Query(tower_pos.first + 0.5, tower_pos.second + 0.5, range,
+                    in_range);
+  for (int i : in_range) {
+    auto enemy_pos = enemies_.GetPosition(i);
+    float distance = sqrt(pow(tower_pos.first + 0.5 - enemy_pos.first, 2) +
+                          pow(tower_pos.second + 0.5 - enemy_pos.second, 2));
+    int distance_left = map_.GetDistance(enemies_.GetTile(i));
+    if (distance <= range && enemies_.IsAlive(i) && distance_left >= 0 &&
+        (distance_left < shortest_distance ||
+         (distance_left == shortest_distance && target != -1 &&
+          enemies_.GetId(i) < enemies_.GetId(target)))) {
+      target = i;
+      shortest_distance = distance_left;
+    }
+  }
+  return target;
+}
+
+void Simulation::ParallelFor(int count, int grain,
+                             const std::function<void(int, int, int)>& job) {
+  if (jobs_) {
+    jobs_->ParallelFor(count, grain, job);
+  } else if (count > 0) {
+    job(0, count, 0);
+  }
+}
+
+void Simulation::SpawnEnemies() {
+  PROFILE_SCOPE(Tick, "SpawnEnemies");
+  while (next_group_ < spawn_queue_.size() &&
+         group_spawned_ == spawn_queue_[next_group_].amount) {
+    next_group_++;
+    group_spawned_ = 0;
+  }
+  if (next_group_ == spawn_queue_.size()) return;
+
+  // Add the next enemy of the group once the delay of the group has passed
+  const MonsterGroup& group = spawn_queue_[next_group_];
+  if (step_ - last_spawn_ > double(group.delay) * STEPS_PER_SECOND) {
+    auto spawn = map_.GetEnemySpawn();
+    enemies_.Add(Enemy(group.max_hp, group.speed, spawn.first + 0.5,
+                       spawn.second + 0.5, group.delay, group.type));
+    group_spawned_++;
+    enemies_to_spawn_--;
+    last_spawn_ = step_;
+  }
+}
+
+int Simulation::GetReward(EnemyTypes type) const {
+  switch (type) {
+    case Standard:
+      return 20;
+    case Fast:
+      return 35;
+    case Big:
+      return 50;
+    case Magic:
+      return 40;
+    case Boss:
+      return 100;
+    default:
+      return 0;
+  }
+}
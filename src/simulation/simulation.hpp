@@ -0,0 +1,95 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+#include "../enemy/enemy.hpp"
+#include "../enemy/enemy_store.hpp"
+#include "../map/map.hpp"
+#include "../player/player.hpp"
+#include "../tower/tower.hpp"
+#include "enemy_grid.hpp"
+#include "job_system.hpp"
+#include "save_game.hpp"
+
+// The game rules without any rendering. Owns the enemies, towers, spawn queue
+// and player of a single game and advances them one fixed step at a time, so a
+// game can be played both by PlayState and headlessly.
+class Simulation {
+ public:
+  // The towers take their prices and stats from the table, which must
+  // outlive the simulation
+  Simulation(const Map& map, const Player& player, const TowerTable& towers);
+  // Spreads the work of each step over the threads of the job system, the
+  // results stay exactly the same. Without one everything runs on the calling
+  // thread.
+  void SetJobSystem(JobSystem* jobs);
+  void Step();
+  void StartWave();
+  Tower* BuyTower(std::unique_ptr<Tower> tower);
+  bool UpgradeTower(const std::pair<int, int>& position);
+  void SellTower(const std::pair<int, int>& position);
+  Tower* GetTower(const std::pair<int, int>& position);
+  const std::map<std::pair<int, int>, std::unique_ptr<Tower>>& GetTowers()
+      const;
+  const EnemyStore& GetEnemies() const;
+  int GetEnemiesRemaining() const;
+  const Map& GetMap() const;
+  const TowerTable& GetTowerTable() const;
+  const Player& GetPlayer() const;
+  int GetWave() const;
+  bool IsWaveActive() const;
+  bool IsGameOver() const;
+  unsigned long GetStep() const;
+  // Hash of the whole game state, two games that were played the same way
+  // have the same hash at every step
+  uint32_t GetStateHash() const;
+  // Writes everything that changes while playing, the map is left out.
+  // Loading replaces the state with the saved one, the game then continues
+  // exactly as the saved game would have. Returns false and keeps the state
+  // if the data is invalid or doesn't end with the state.
+  void Save(SaveGame::Writer& writer) const;
+  bool Load(SaveGame::Reader& reader);
+
+  static const int STEPS_PER_SECOND = 60;
+
+ private:
+  // td-bench measures the target selection of a step on its own
+  friend class SimulationBenchmark;
+
+  void MoveEnemies();
+  void FindEnemies();
+  void SelectTargets();
+  void SpawnEnemies();
+  int SelectTarget(const Tower& tower, std::vector<int>& in_range) const;
+  void ParallelFor(int count, int grain,
+                   const std::function<void(int, int, int)>& job);
+  int GetReward(EnemyTypes type) const;
+
+  Map map_;
+  const TowerTable& tower_table_;
+  EnemyStore enemies_;
+  EnemyGrid enemy_grid_;
+  JobSystem* jobs_;
+  // Enemies in range of a tower, one buffer per thread
+  std::vector<std::vector<int>> in_range_;
+  // Towers that can attack in this step and the enemy each of them chose
+  std::vector<Tower*> ready_towers_;
+  std::vector<int> targets_;
+  // Groups of the current wave in spawn order, their enemies are only
+  // created when it is their turn to spawn
+  std::vector<MonsterGroup> spawn_queue_;
+  size_t next_group_;
+  // Enemies of the next group that have spawned already
+  int group_spawned_;
+  int enemies_to_spawn_;
+  std::map<std::pair<int, int>, std::unique_ptr<Tower>> towers_;
+  Player player_;
+  // Times are counted in steps, a float of seconds would stop telling steps
+  // apart in long games
+  unsigned long step_;
+  unsigned long last_spawn_;
+  int wave_;
+  bool wave_active_;
+  int money_per_wave_;
+};
@@ -0,0 +1,270 @@
+#include "simulation_runner.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include "../profiler/profiler.hpp"
+
+SimulationRunner::SimulationRunner(const Map& map, const Player& player,
+                                   const TowerTable& towers)
+    : simulation_(map, player, towers),
+      stop_(false),
+      time_scale_(1),
+      command_since_hash_(true),
+      back_(0),
+      ready_(1),
+      front_(2),
+      fresh_(false) {}
+
+SimulationRunner::~SimulationRunner() {
+  Stop();
+  if (recorder_.IsOpen() && !recorder_.Close()) {
+    std::cout << "Failed to write the replay" << std::endl;
+  }
+}
+
+void SimulationRunner::SetJobSystem(JobSystem* jobs) {
+  simulation_.SetJobSystem(jobs);
+}
+
+bool SimulationRunner::StartRecording(const std::string& file_path,
+                                      const std::string& map_name) {
+  std::lock_guard<std::mutex> lock(simulation_mutex_);
+  if (recorder_.IsOpen()) return false;
+  // Replays start at the beginning of the game
+  if (simulation_.GetStep() != 0) return false;
+  return recorder_.Open(file_path, map_name, simulation_.GetMap(),
+                        simulation_.GetTowerTable(), simulation_.GetPlayer());
+}
+
+void SimulationRunner::Start() {
+  if (thread_.joinable()) return;
+  stop_ = false;
+  last_publish_ = std::chrono::steady_clock::now();
+  Publish();
+  thread_ = std::thread(&SimulationRunner::Run, this);
+}
+
+void SimulationRunner::Stop() {
+  if (!thread_.joinable()) return;
+  stop_ = true;
+  thread_.join();
+}
+
+void SimulationRunner::SetTimeScale(float time_scale) {
+  time_scale_ = time_scale;
+}
+
+const Snapshot& SimulationRunner::GetSnapshot() {
+  std::lock_guard<std::mutex> lock(snapshot_mutex_);
+  if (fresh_) {
+    std::swap(front_, ready_);
+    fresh_ = false;
+  }
+  return snapshots_[front_];
+}
+
+const Map& SimulationRunner::GetMap() const { return simulation_.GetMap(); }
+const TowerTable& SimulationRunner::GetTowerTable() const {
+  return simulation_.GetTowerTable();
+}
+
+// Commands that the simulation accepted are recorded
+bool SimulationRunner::BuyTower(std::unique_ptr<Tower> tower) {
+  std::lock_guard<std::mutex> lock(simulation_mutex_);
+  Tower* bought = simulation_.BuyTower(std::move(tower));
+  if (!bought) return false;
+  Record(Replay::BuyTowerEntry, bought->GetPosition(), bought->GetType());
+  return true;
+}
+
+bool SimulationRunner::UpgradeTower(const std::pair<int, int>& position) {
+  std::lock_guard<std::mutex> lock(simulation_mutex_);
+  if (!simulation_.UpgradeTower(position)) return false;
+  Record(Replay::UpgradeTowerEntry, position);
+  return true;
+}
+
+void SimulationRunner::SellTower(const std::pair<int, int>& position) {
+  std::lock_guard<std::mutex> lock(simulation_mutex_);
+  if (!simulation_.GetTower(position)) return;
+  simulation_.SellTower(position);
+  Record(Replay::SellTowerEntry, position);
+}
+
+void SimulationRunner::StartWave() {
+  std::lock_guard<std::mutex> lock(simulation_mutex_);
+  if (simulation_.IsWaveActive()) return;
+  simulation_.StartWave();
+  Record(Replay::StartWaveEntry, {0, 0});
+}
+
+bool SimulationRunner::Save(const std::string& file_path,
+                            const std::string& map_name) {
+  SaveGame::Writer writer;
+  {
+    std::lock_guard<std::mutex> lock(simulation_mutex_);
+    SaveGame::Save(map_name, simulation_, writer);
+  }
+  return writer.WriteFile(file_path);
+}
+
+bool SimulationRunner::Load(const std::string& file_path) {
+  SaveGame::Reader reader;
+  if (!reader.ReadFile(file_path)) return false;
+  std::lock_guard<std::mutex> lock(simulation_mutex_);
+  if (!SaveGame::Load(reader, simulation_)) return false;
+  if (recorder_.IsOpen()) {
+    std::cout << "Stopped recording the replay at the loaded game"
+              << std::endl;
+    if (!recorder_.Close()) {
+      std::cout << "Failed to write the replay" << std::endl;
+    }
+  }
+  // Loaded enemies appear where they are instead of moving there
+  published_.clear();
+  return true;
+}
+
+// Steps the simulation as often as the elapsed time and time scale call for
+// and publishes a snapshot after each batch of steps
+void SimulationRunner::Run() {
+  typedef std::chrono::steady_clock Clock;
+  const float step_time = 1.f / Simulation::STEPS_PER_SECOND;
+  auto last_time = Clock::now();
+  float accumulator = 0;
+  while (!stop_) {
+    auto now = Clock::now();
+    float elapsed = std::chrono::duration<float>(now - last_time).count();
+    last_time = now;
+    float time_scale = time_scale_;
+    int steps = 0;
+    if (std::isinf(time_scale)) {
+      // Unlimited speed, publish about as often as at normal speed
+      auto end = now + std::chrono::duration<float>(step_time);
+      while (Clock::now() < end && !stop_) {
+        Step();
+        steps++;
+      }
+      accumulator = 0;
+    } else {
+      // Don't try to catch up after very long pauses
+      accumulator += std::min(elapsed, 0.25f) * time_scale;
+      while (accumulator >= step_time && !stop_) {
+        Step();
+        accumulator -= step_time;
+        steps++;
+      }
+    }
+    if (steps > 0) Publish();
+
+    if (!std::isinf(time_scale)) {
+      // Sleep until the next step is due, but at least half a step so that
+      // fast time scales step in batches instead of publishing every step
+      float sleep = std::max((step_time - accumulator) / time_scale,
+                             step_time / 2);
+      std::this_thread::sleep_for(std::chrono::duration<float>(sleep));
+    }
+  }
+}
+
+void SimulationRunner::Step() {
+  {
+    PROFILE_SCOPE(Tick, "Tick");
+    std::lock_guard<std::mutex> lock(simulation_mutex_);
+    bool wave_active = simulation_.IsWaveActive();
+    simulation_.Step();
+    PROFILE_COUNT(Tick, "Enemies", simulation_.GetEnemies().Size());
+    // Between waves only commands change the game, so idle steps aren't
+    // hashed. The step that ends a wave still is.
+    if (recorder_.IsOpen() && (wave_active || command_since_hash_)) {
+      Replay::Entry entry = {};
+      entry.step = simulation_.GetStep();
+      entry.type = Replay::StateHashEntry;
+      entry.hash = simulation_.GetStateHash();
+      recorder_.Write(entry);
+      command_since_hash_ = false;
+    }
+  }
+  profiler.EndFrame(Profiler::Tick);
+}
+
+// Must be called with simulation_mutex_ held
+void SimulationRunner::Record(Replay::EntryTypes type,
+                              const std::pair<int, int>& position,
+                              TowerTypes tower) {
+  if (!recorder_.IsOpen()) return;
+  command_since_hash_ = true;
+  Replay::Entry entry = {};
+  entry.step = simulation_.GetStep();
+  entry.type = type;
+  entry.tower = tower;
+  entry.position = position;
+  recorder_.Write(entry);
+}
+
+void SimulationRunner::Publish() {
+  PROFILE_SCOPE(Tick, "Publish");
+  Snapshot& snapshot = snapshots_[back_];
+  {
+    std::lock_guard<std::mutex> lock(simulation_mutex_);
+    auto now = std::chrono::steady_clock::now();
+    snapshot.step = simulation_.GetStep();
+    snapshot.interval =
+        std::chrono::duration<float>(now - last_publish_).count();
+    snapshot.time = now;
+    last_publish_ = now;
+
+    const EnemyStore& enemies = simulation_.GetEnemies();
+    snapshot.x.clear();
+    snapshot.y.clear();
+    snapshot.previous_x.clear();
+    snapshot.previous_y.clear();
+    snapshot.hp.clear();
+    snapshot.max_hp.clear();
+    snapshot.type.clear();
+    for (int i = 0; i < enemies.Size(); i++) {
+      if (!enemies.IsAlive(i)) continue;
+      auto position = enemies.GetPosition(i);
+      Handle handle = enemies.GetHandle(i);
+      if (handle.slot >= published_.size()) {
+        published_.resize(handle.slot + 1, Published{0, 0, 0});
+      }
+      // Enemies that weren't in the last snapshot appear where they are
+      Published& published = published_[handle.slot];
+      bool known = published.generation == handle.generation;
+      snapshot.x.push_back(position.first);
+      snapshot.y.push_back(position.second);
+      snapshot.previous_x.push_back(known ? published.x : position.first);
+      snapshot.previous_y.push_back(known ? published.y : position.second);
+      snapshot.hp.push_back(enemies.GetHp(i));
+      snapshot.max_hp.push_back(enemies.GetMaxHp(i));
+      snapshot.type.push_back(enemies.GetType(i));
+      published = {handle.generation, position.first, position.second};
+    }
+
+    snapshot.towers.clear();
+    snapshot.targets.clear();
+    for (auto& tower : simulation_.GetTowers()) {
+      snapshot.towers.push_back({tower.first, tower.second->GetType(),
+                                 tower.second->GetCurrentUpgrade()});
+      int target = enemies.GetIndex(tower.second->GetTarget());
+      if (target == -1 || !enemies.IsAlive(target)) continue;
+      auto position = enemies.GetPosition(target);
+      snapshot.targets.push_back({tower.first, position.first,
+                                  position.second});
+    }
+
+    const Player& player = simulation_.GetPlayer();
+    snapshot.player_name = player.GetName();
+    snapshot.money = player.GetMoney();
+    snapshot.lives = player.GetLives();
+    snapshot.wave = simulation_.GetWave();
+    snapshot.enemies_remaining = simulation_.GetEnemiesRemaining();
+    snapshot.wave_active = simulation_.IsWaveActive();
+    snapshot.game_over = simulation_.IsGameOver();
+  }
+
+  std::lock_guard<std::mutex> lock(snapshot_mutex_);
+  std::swap(back_, ready_);
+  fresh_ = true;
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "job_system.hpp"
+#include "replay.hpp"
+#include "simulation.hpp"
+
+// What the game shows of a simulation at one step. The simulation thread
+// publishes a new one after it stepped, and it doesn't change afterwards.
+struct Snapshot {
+  struct TowerState {
+    std::pair<int, int> position;
+    TowerTypes type;
+    // The upgrade level, its stats are in the tower table
+    int level;
+  };
+  struct Target {
+    std::pair<int, int> tower;
+    float x, y;
+  };
+
+  unsigned long step = 0;
+  // When the snapshot was published and how long after the one before
+  std::chrono::steady_clock::time_point time;
+  float interval = 0;
+  // The living enemies, with the position they had in the previous snapshot
+  // so that they can be drawn in between
+  std::vector<float> x, y, previous_x, previous_y;
+  std::vector<float> hp, max_hp;
+  std::vector<EnemyTypes> type;
+  std::vector<TowerState> towers;
+  // The enemy each tower attacked last, if it is still alive
+  std::vector<Target> targets;
+  std::string player_name;
+  int money = 0;
+  int lives = 0;
+  int wave = 0;
+  int enemies_remaining = 0;
+  bool wave_active = false;
+  bool game_over = false;
+};
+
+// Runs a simulation at a fixed rate on its own thread, so that slow frames
+// and slow steps don't hold each other up. Snapshots are triple buffered: the
+// simulation thread fills one while the main thread draws another and the
+// third holds the newest finished one.
+//
+// Only the main thread may call the other methods. The towers belong to the
+// simulation thread like the enemies, the game sees them in the snapshots.
+class SimulationRunner {
+ public:
+  SimulationRunner(const Map& map, const Player& player,
+                   const TowerTable& towers);
+  ~SimulationRunner();
+  void SetJobSystem(JobSystem* jobs);
+  // Logs every command and the state hash of every step that can change the
+  // game to a replay file from now on, until the runner is destroyed
+  bool StartRecording(const std::string& file_path,
+                      const std::string& map_name);
+  void Start();
+  void Stop();
+  // Steps per second are multiplied by the time scale, infinity runs the
+  // simulation as fast as possible
+  void SetTimeScale(float time_scale);
+  // Returns the newest snapshot, it stays valid until the next call
+  const Snapshot& GetSnapshot();
+
+  const Map& GetMap() const;
+  const TowerTable& GetTowerTable() const;
+  // Change the simulation between two steps, the next snapshot shows the
+  // change
+  bool BuyTower(std::unique_ptr<Tower> tower);
+  bool UpgradeTower(const std::pair<int, int>& position);
+  void SellTower(const std::pair<int, int>& position);
+  void StartWave();
+  // Saves the game between two steps, the file is written afterwards
+  bool Save(const std::string& file_path, const std::string& map_name);
+  // Continues a game saved on the same map. A replay can't follow a load, so
+  // recording stops.
+  bool Load(const std::string& file_path);
+
+ private:
+  void Run();
+  void Step();
+  void Publish();
+  void Record(Replay::EntryTypes type, const std::pair<int, int>& position,
+              TowerTypes tower = Basic);
+
+  Simulation simulation_;
+  // Held by the simulation thread while it steps
+  std::mutex simulation_mutex_;
+  std::thread thread_;
+  std::atomic<bool> stop_;
+  std::atomic<float> time_scale_;
+  // Guarded by simulation_mutex_ like the simulation
+  Replay::Writer recorder_;
+  // Whether a command was recorded since the last state hash, the first
+  // step is always hashed
+  bool command_since_hash_;
+
+  Snapshot snapshots_[3];
+  // Only the simulation thread touches back_, only the main thread front_
+  int back_;
+  int ready_;
+  int front_;
+  bool fresh_;
+  std::mutex snapshot_mutex_;
+
+  // Positions in the last published snapshot by the slot of the enemy
+  // handle, guarded by simulation_mutex_
+  struct Published {
+    unsigned generation;
+    float x, y;
+  };
+  std::vector<Published> published_;
+  std::chrono::steady_clock::time_point last_publish_;
+};
@@ -1,52 +1,45 @@
 #pragma once
 #include <string>
-#include "../enemy/enemy.hpp"
-#include "SFML/Graphics.hpp"
+#include "../enemy/enemy_store.hpp"
+#include "tower_table.hpp"
+#include "tower_types.hpp"
 
-class Tower : public sf::Drawable {
+// A tower on the map. Its stats come from the tower table it was made with at
+// its type and current upgrade level, the rest of its definition from
+// TOWER_DEFINITIONS. The table must outlive the tower.
+class Tower {
  public:
-  Tower(float range, float damage, float att_speed, int x, int y, float size,
-        int price, const std::string& texturename = "sprites/basic_tower.png");
-  bool Attack(Enemy& enemy) const;
+  Tower(TowerTypes type, int x, int y, const TowerTable& table);
+  bool Attack(EnemyStore& enemies, int enemy) const;
   const std::pair<int, int> GetPosition() const;
 
+  TowerTypes GetType() const;
+  const TowerDefinition& GetDefinition() const;
   float GetRange() const;
   float GetAttSpeed() const;
   float GetDamage() const;
-  float GetLastAttack() const;
+  // The simulation step of the last attack
+  unsigned long GetLastAttack() const;
   int GetMoneyPerWave() const;
-  void SetLastAttack(float att_time);
-  sf::Texture& GetTexture() const;
-  sf::Sprite* GetSprite();
-  void SetPosition(float x, float y);
-  void SetScale(float factor_x, float factor_y);
-  void SetActive();
-  void SetInactive();
-  bool IsActive() const;
+  void SetLastAttack(unsigned long step);
+  // The enemy attacked last, the handle is stale once the enemy is removed
+  Handle GetTarget() const;
+  void SetTarget(const Handle& target);
+  const std::string& GetTextureName() const;
   int GetPrice() const;
   int GetCurrentUpgrade() const;
   bool IsUpgradeable() const;
-  virtual void Upgrade() = 0;
+  void Upgrade();
   int GetUpgradePrice() const;
-  virtual ~Tower(){};
-
- protected:
-  int max_upgrade_;
-  float range_;
-  float damage_;
-  int current_upgrade_;
-  float att_speed_;
-  int upgrade_price_;
-  int money_per_wave_;
 
  private:
+  const TowerLevel& GetLevel() const;
+
+  TowerTypes type_;
+  const TowerTable& table_;
+  // Starts at 1
+  int current_upgrade_;
   int x_, y_;
-  float size_;
-  int price_;
-  std::string texturename_;
-  float last_attack_;
-  sf::Sprite sprite_;
-  sf::CircleShape radius_;
-  bool active_;
-  virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const;
-};
\ No newline at end of file
+  unsigned long last_attack_;
+  Handle target_;
+};
@@ -0,0 +1,113 @@
+#include "tower_table.hpp"
+
+namespace {
+// Reads an optional number of a level, which is 0 if it's missing. Returns
+// false if it isn't a number.
+template <typename T>
+bool GetNumber(const boost::property_tree::ptree& level, const char* name,
+               T& value) {
+  value = 0;
+  auto child = level.get_child_optional(name);
+  if (!child) return true;
+  auto number = child->get_value_optional<T>();
+  if (!number) return false;
+  value = *number;
+  return true;
+}
+}  // namespace
+
+TowerTable::TowerTable() { Reset(); }
+
+void TowerTable::Reset() {
+  levels_.clear();
+  for (int i = 0; i < TOWER_TYPE_COUNT; i++) {
+    const TowerDefinition& definition = TOWER_DEFINITIONS[i];
+    prices_[i] = definition.price;
+    levels_begin_[i] = levels_.size();
+    levels_.insert(levels_.end(), definition.levels,
+                   definition.levels + definition.level_count);
+  }
+  levels_begin_[TOWER_TYPE_COUNT] = levels_.size();
+}
+
+bool TowerTable::Load(const boost::property_tree::ptree& towers,
+                      std::string& error_message) {
+  // Every type starts with its defaults and is replaced if the file has it
+  int prices[TOWER_TYPE_COUNT];
+  std::vector<TowerLevel> type_levels[TOWER_TYPE_COUNT];
+  for (int i = 0; i < TOWER_TYPE_COUNT; i++) {
+    const TowerDefinition& definition = TOWER_DEFINITIONS[i];
+    prices[i] = definition.price;
+    type_levels[i].assign(definition.levels,
+                          definition.levels + definition.level_count);
+  }
+  for (auto& tower : towers) {
+    TowerTypes type;
+    if (!GetTowerType(tower.first, type)) {
+      error_message = tower.first + ": unknown tower type";
+      return false;
+    }
+    auto price = tower.second.get_optional<int>("price");
+    auto levels = tower.second.get_child_optional("levels");
+    if (!price || !levels || levels->empty()) {
+      error_message = tower.first + ": price and levels are required";
+      return false;
+    }
+    if (*price <= 0) {
+      error_message = tower.first + ": price out of range";
+      return false;
+    }
+    prices[type] = *price;
+    type_levels[type].clear();
+    // Levels are a list, range, damage, att_speed, money_per_wave and
+    // upgrade_price of each are 0 if left out
+    for (auto& level : *levels) {
+      std::string level_name = tower.first + " level " +
+                               std::to_string(type_levels[type].size() + 1);
+      TowerLevel tower_level;
+      if (!GetNumber(level.second, "range", tower_level.range) ||
+          !GetNumber(level.second, "damage", tower_level.damage) ||
+          !GetNumber(level.second, "att_speed", tower_level.att_speed) ||
+          !GetNumber(level.second, "money_per_wave",
+                     tower_level.money_per_wave) ||
+          !GetNumber(level.second, "upgrade_price",
+                     tower_level.upgrade_price)) {
+        error_message = level_name + ": values must be numbers";
+        return false;
+      }
+      if (!IsValidLevel(tower_level, GetTowerDefinition(type).targeting)) {
+        error_message = level_name + ": values out of range";
+        return false;
+      }
+      type_levels[type].push_back(tower_level);
+    }
+  }
+
+  levels_.clear();
+  for (int i = 0; i < TOWER_TYPE_COUNT; i++) {
+    prices_[i] = prices[i];
+    levels_begin_[i] = levels_.size();
+    levels_.insert(levels_.end(), type_levels[i].begin(),
+                   type_levels[i].end());
+  }
+  levels_begin_[TOWER_TYPE_COUNT] = levels_.size();
+  return true;
+}
+
+int TowerTable::GetPrice(TowerTypes type) const { return prices_[type]; }
+
+int TowerTable::GetLevelCount(TowerTypes type) const {
+  return levels_begin_[type + 1] - levels_begin_[type];
+}
+
+int TowerTable::GetLevelsBegin(TowerTypes type) const {
+  return levels_begin_[type];
+}
+
+const TowerLevel& TowerTable::GetLevel(TowerTypes type, int level) const {
+  return levels_[levels_begin_[type] + level - 1];
+}
+
+const std::vector<TowerLevel>& TowerTable::GetLevels() const {
+  return levels_;
+}
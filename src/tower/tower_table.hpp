@@ -0,0 +1,33 @@
+#pragma once
+#include <boost/property_tree/ptree.hpp>
+#include <string>
+#include <vector>
+#include "tower_types.hpp"
+
+// The prices and per-level stats of every tower type. The levels of all types
+// are in one array, level n of a type is at GetLevelsBegin(type) + n - 1, so a
+// tower looks up its stats by index.
+class TowerTable {
+ public:
+  // Starts with the defaults of TOWER_DEFINITIONS
+  TowerTable();
+  void Reset();
+  // Reads the "towers" tree of a towers.json file, keyed by the type names of
+  // GetTowerTypeName. Types it leaves out keep their defaults. Returns false
+  // and describes the problem in error_message if anything is invalid, the
+  // table is unchanged then.
+  bool Load(const boost::property_tree::ptree& towers,
+            std::string& error_message);
+  int GetPrice(TowerTypes type) const;
+  int GetLevelCount(TowerTypes type) const;
+  int GetLevelsBegin(TowerTypes type) const;
+  // Levels are numbered from 1
+  const TowerLevel& GetLevel(TowerTypes type, int level) const;
+  const std::vector<TowerLevel>& GetLevels() const;
+
+ private:
+  int prices_[TOWER_TYPE_COUNT];
+  // Index of the first level of each type, and of the end of the levels
+  int levels_begin_[TOWER_TYPE_COUNT + 1];
+  std::vector<TowerLevel> levels_;
+};
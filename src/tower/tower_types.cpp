@@ -0,0 +1,62 @@
+#include "tower_types.hpp"
+#include "../map/map.hpp"
+#include "tower.hpp"
+
+namespace {
+// The names and textures as strings, so that they can be used without
+// allocating
+struct TowerStrings {
+  std::string names[TOWER_TYPE_COUNT];
+  std::string textures[TOWER_TYPE_COUNT];
+};
+
+const TowerStrings& GetTowerStrings() {
+  static const TowerStrings strings([] {
+    TowerStrings strings;
+    for (int i = 0; i < TOWER_TYPE_COUNT; i++) {
+      strings.names[i] = TOWER_DEFINITIONS[i].name;
+      strings.textures[i] = TOWER_DEFINITIONS[i].texture;
+    }
+    return strings;
+  }());
+  return strings;
+}
+}  // namespace
+
+const std::string& GetTowerTypeName(TowerTypes type) {
+  return GetTowerStrings().names[type];
+}
+
+const std::string& GetTowerTextureName(TowerTypes type) {
+  return GetTowerStrings().textures[type];
+}
+
+bool GetTowerType(const std::string& name, TowerTypes& type) {
+  for (int i = 0; i < TOWER_TYPE_COUNT; i++) {
+    if (name == GetTowerStrings().names[i]) {
+      type = TowerTypes(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool CanPlaceTower(TowerTypes type, const Map& map, int x, int y) {
+  if (x < 0 || y < 0 || x >= map.GetWidth() || y >= map.GetHeight()) {
+    return false;
+  }
+  TileTypes tile = map(x, y);
+  switch (GetTowerDefinition(type).placement) {
+    case OnLand:
+      return tile == Empty;
+    case OnWater:
+      return tile == Water1 || tile == Water2;
+    default:
+      return false;
+  }
+}
+
+std::unique_ptr<Tower> MakeTower(TowerTypes type, int x, int y,
+                                 const TowerTable& table) {
+  return std::make_unique<Tower>(type, x, y, table);
+}
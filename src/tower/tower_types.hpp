@@ -0,0 +1,121 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+
+class Map;
+class Tower;
+class TowerTable;
+
+// Every kind of tower the shop sells is defined by one entry of
+// TOWER_DEFINITIONS below. The towers, the shop and the placement checks are
+// all built from the table, so adding a type only takes a new enum value and
+// its entry. The prices and levels in it are the defaults of the TowerTable,
+// which towers.json can change without recompiling.
+enum TowerTypes : uint8_t { Basic, Ship, Money };
+const int TOWER_TYPE_COUNT = Money + 1;
+// Of the defaults, towers.json can define any number of levels
+const int MAX_TOWER_LEVELS = 4;
+
+// The tiles a tower can be built on
+enum PlacementRules : uint8_t { OnLand, OnWater };
+
+// Which enemy in range a tower attacks
+enum TargetingModes : uint8_t {
+  // The one closest to the player base
+  TargetFirst,
+  // None, the tower doesn't attack
+  TargetNone
+};
+
+struct TowerLevel {
+  float range;
+  float damage;
+  // Attacks per second
+  float att_speed;
+  int money_per_wave;
+  // Price of the upgrade to the next level
+  int upgrade_price;
+};
+
+struct TowerDefinition {
+  // Used in files, e.g. balancing layouts
+  const char* name;
+  // Shown in the shop
+  const char* title;
+  const char* texture;
+  int price;
+  PlacementRules placement;
+  TargetingModes targeting;
+  int level_count;
+  TowerLevel levels[MAX_TOWER_LEVELS];
+};
+
+constexpr TowerDefinition TOWER_DEFINITIONS[] = {
+    {"basic", "Old Tower", "sprites/basic_tower.png", 250, OnLand,
+     TargetFirst, 4,
+     {{5, 10, 1, 0, 100},
+      {5, 13, 1, 0, 150},
+      {6, 15, 1, 0, 200},
+      {6, 17, 1.5, 0, 300}}},
+    {"ship", "Pirate Ship", "sprites/ship_tower.png", 400, OnWater,
+     TargetFirst, 4,
+     {{8, 5, 1, 0, 100},
+      {8, 10, 1, 0, 100},
+      {10, 12, 1, 0, 200},
+      {10, 14, 2, 0, 300}}},
+    {"money", "Mine", "sprites/money_tower.png", 300, OnLand, TargetNone, 4,
+     {{0, 0, 0, 100, 100},
+      {0, 0, 0, 150, 150},
+      {0, 0, 0, 200, 200},
+      {0, 0, 0, 250, 300}}}};
+
+constexpr const TowerDefinition& GetTowerDefinition(TowerTypes type) {
+  return TOWER_DEFINITIONS[type];
+}
+
+// Towers that attack need to attack at some speed
+constexpr bool IsValidLevel(const TowerLevel& level, TargetingModes targeting) {
+  return level.range >= 0 && level.damage >= 0 && level.att_speed >= 0 &&
+         level.money_per_wave >= 0 && level.upgrade_price >= 0 &&
+         (targeting == TargetNone || level.att_speed > 0);
+}
+
+// Checked when compiling, so a broken definition never gets to the game
+constexpr bool IsValidDefinition(const TowerDefinition& definition) {
+  if (definition.price <= 0 || definition.level_count < 1 ||
+      definition.level_count > MAX_TOWER_LEVELS) {
+    return false;
+  }
+  for (int i = 0; i < definition.level_count; i++) {
+    if (!IsValidLevel(definition.levels[i], definition.targeting)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+constexpr bool AreValidDefinitions(int count) {
+  for (int i = 0; i < count; i++) {
+    if (!IsValidDefinition(TOWER_DEFINITIONS[i])) return false;
+  }
+  return true;
+}
+
+static_assert(sizeof(TOWER_DEFINITIONS) / sizeof(TOWER_DEFINITIONS[0]) ==
+                  TOWER_TYPE_COUNT,
+              "Every tower type needs a definition");
+static_assert(AreValidDefinitions(TOWER_TYPE_COUNT),
+              "A tower definition is invalid");
+
+const std::string& GetTowerTypeName(TowerTypes type);
+const std::string& GetTowerTextureName(TowerTypes type);
+// Looks up a type by the name GetTowerTypeName gives it
+bool GetTowerType(const std::string& name, TowerTypes& type);
+// Whether the tile at x, y exists and the type can be built on it. Other
+// towers on the tile aren't checked.
+bool CanPlaceTower(TowerTypes type, const Map& map, int x, int y);
+// Creates a new tower of the type as the shop sells it, with the stats of the
+// table
+std::unique_ptr<Tower> MakeTower(TowerTypes type, int x, int y,
+                                 const TowerTable& table);
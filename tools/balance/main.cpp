@@ -0,0 +1,399 @@
+#include <boost/property_tree/json_parser.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "configuration/configmanager.hpp"
+#include "game/wavemanager.hpp"
+#include "map/map.hpp"
+#include "simulation/job_system.hpp"
+#include "simulation/simulation.hpp"
+#include "tower/tower_types.hpp"
+
+namespace {
+struct TowerPlacement {
+  TowerTypes type;
+  int x, y;
+  int level;
+};
+
+struct Layout {
+  std::string name;
+  std::vector<TowerPlacement> towers;
+};
+
+// What happened during one wave of one run
+struct WaveResult {
+  int spawned = 0;
+  int leaked = 0;
+  int money = 0;
+  unsigned long steps = 0;
+};
+
+struct RunResult {
+  std::vector<WaveResult> waves;
+  unsigned long enemy_steps = 0;
+};
+
+struct Options {
+  std::string map_file = "map.txt";
+  std::string waves_file = "waves.json";
+  // The tower stats to play with, by default the ones the game uses on the map
+  std::string towers_file;
+  std::string output;
+  std::string format = "csv";
+  int runs = 100;
+  int jitter = 1;
+  int lives = 3;
+  int threads = std::thread::hardware_concurrency();
+  unsigned seed = 1;
+  // Ten minutes of game time per wave at most
+  unsigned long max_steps = 600 * Simulation::STEPS_PER_SECOND;
+};
+
+// Reads {"layouts": {"<name>": [{"type", "x", "y", "level"}, ...]}}
+bool LoadLayouts(const std::string& file_path, const Map& map,
+                 const TowerTable& tower_table, std::vector<Layout>& layouts) {
+  boost::property_tree::ptree tree;
+  try {
+    boost::property_tree::json_parser::read_json(file_path, tree);
+  } catch (boost::property_tree::json_parser::json_parser_error const& e) {
+    std::cout << file_path << ": " << e.message() << std::endl;
+    return false;
+  }
+  auto layouts_tree = tree.get_child_optional("layouts");
+  if (!layouts_tree) {
+    std::cout << file_path << ": No layouts found" << std::endl;
+    return false;
+  }
+  for (auto& layout_tree : *layouts_tree) {
+    Layout layout;
+    layout.name = layout_tree.first;
+    // The towers are bought as they are read, so the layout follows the
+    // same placement rules as the game
+    Simulation check(map, Player("balance", 1, std::numeric_limits<int>::max()),
+                     tower_table);
+    for (auto& tower_tree : layout_tree.second) {
+      auto type_name = tower_tree.second.get_optional<std::string>("type");
+      auto x = tower_tree.second.get_optional<int>("x");
+      auto y = tower_tree.second.get_optional<int>("y");
+      int level = tower_tree.second.get<int>("level", 1);
+      if (!type_name || !x || !y) {
+        std::cout << file_path << ": " << layout.name
+                  << ": type, x and y are required" << std::endl;
+        return false;
+      }
+      TowerTypes type;
+      if (!GetTowerType(*type_name, type)) {
+        std::cout << file_path << ": " << layout.name << ": unknown tower "
+                  << *type_name << std::endl;
+        return false;
+      }
+      if (!check.BuyTower(MakeTower(type, *x, *y, tower_table))) {
+        std::cout << file_path << ": " << layout.name << ": can't place "
+                  << *type_name << " at " << *x << "," << *y << std::endl;
+        return false;
+      }
+      layout.towers.push_back({type, *x, *y, level});
+    }
+    layouts.push_back(layout);
+  }
+  return !layouts.empty();
+}
+
+// Moves every tower to a random free tile at most jitter tiles away. Towers
+// that find no free tile stay where the layout has them, so the tiles of the
+// towers that haven't moved yet are taken too.
+std::vector<TowerPlacement> Randomize(const Map& map, const Layout& layout,
+                                      int jitter, std::mt19937& rng) {
+  std::vector<TowerPlacement> towers = layout.towers;
+  std::uniform_int_distribution<int> offset(-jitter, jitter);
+  std::vector<std::pair<int, int>> taken;
+  for (auto& tower : towers) {
+    taken.push_back({tower.x, tower.y});
+  }
+  for (size_t i = 0; i < towers.size(); i++) {
+    TowerPlacement& tower = towers[i];
+    for (int attempt = 0; attempt < 20 && jitter > 0; attempt++) {
+      int x = tower.x + offset(rng);
+      int y = tower.y + offset(rng);
+      if (CanPlaceTower(tower.type, map, x, y) &&
+          std::find(taken.begin(), taken.end(), std::make_pair(x, y)) ==
+              taken.end()) {
+        tower.x = x;
+        tower.y = y;
+        taken[i] = {x, y};
+        break;
+      }
+    }
+  }
+  return towers;
+}
+
+// Plays every wave with the towers placed for free up front. The player can't
+// lose, so the lives lost count every enemy that reached the base. Returns
+// false if the simulation refused a tower.
+bool Simulate(const Map& map, const TowerTable& tower_table,
+              const std::vector<TowerPlacement>& towers, const Options& options,
+              RunResult& result) {
+  const int lives = std::numeric_limits<int>::max() / 2;
+  int price = 0;
+  std::vector<std::unique_ptr<Tower>> built;
+  for (auto& placement : towers) {
+    built.push_back(
+        MakeTower(placement.type, placement.x, placement.y, tower_table));
+    for (int level = 1; level < placement.level; level++) {
+      built.back()->Upgrade();
+    }
+    price += built.back()->GetPrice();
+  }
+  Simulation simulation(map, Player("balance", lives, price), tower_table);
+  for (auto& tower : built) {
+    auto position = tower->GetPosition();
+    if (!simulation.BuyTower(std::move(tower))) {
+      std::cout << "Can't place a tower at " << position.first << ","
+                << position.second << std::endl;
+      return false;
+    }
+  }
+
+  int wave_count = map.GetWaves().GetWaveCount();
+  for (int wave = 1; wave <= wave_count; wave++) {
+    WaveResult wave_result;
+    int lives_before = simulation.GetPlayer().GetLives();
+    unsigned long start = simulation.GetStep();
+    simulation.StartWave();
+    wave_result.spawned = simulation.GetEnemiesRemaining();
+    while (simulation.IsWaveActive() &&
+           simulation.GetStep() - start < options.max_steps) {
+      simulation.Step();
+      result.enemy_steps += simulation.GetEnemies().Size();
+    }
+    wave_result.leaked = lives_before - simulation.GetPlayer().GetLives();
+    wave_result.money = simulation.GetPlayer().GetMoney();
+    wave_result.steps = simulation.GetStep() - start;
+    result.waves.push_back(wave_result);
+    if (simulation.IsWaveActive()) break;
+  }
+  return true;
+}
+
+// Averages of one wave over all runs of a layout
+struct WaveSummary {
+  int wave;
+  int runs = 0;
+  double leak_rate = 0;
+  double lives_lost = 0;
+  double money = 0;
+  double time_to_clear = 0;
+  // Share of the runs in which the player would still be alive
+  double survival = 0;
+};
+
+std::vector<WaveSummary> Summarize(const std::vector<RunResult>& runs,
+                                   int lives) {
+  std::vector<WaveSummary> summaries;
+  for (auto& run : runs) {
+    int lives_lost = 0;
+    for (size_t i = 0; i < run.waves.size(); i++) {
+      const WaveResult& wave = run.waves[i];
+      if (summaries.size() <= i) {
+        summaries.push_back(WaveSummary());
+        summaries.back().wave = i + 1;
+      }
+      WaveSummary& summary = summaries[i];
+      lives_lost += wave.leaked;
+      summary.runs++;
+      summary.leak_rate +=
+          wave.spawned > 0 ? double(wave.leaked) / wave.spawned : 0;
+      summary.lives_lost += wave.leaked;
+      summary.money += wave.money;
+      summary.time_to_clear +=
+          double(wave.steps) / Simulation::STEPS_PER_SECOND;
+      summary.survival += lives_lost < lives;
+    }
+  }
+  for (auto& summary : summaries) {
+    summary.leak_rate /= summary.runs;
+    summary.lives_lost /= summary.runs;
+    summary.money /= summary.runs;
+    summary.time_to_clear /= summary.runs;
+    summary.survival /= summary.runs;
+  }
+  return summaries;
+}
+
+void WriteCsv(std::ostream& os, const std::vector<Layout>& layouts,
+              const std::vector<std::vector<WaveSummary>>& summaries) {
+  os << "layout,wave,runs,leak_rate,lives_lost,money,time_to_clear,survival"
+     << std::endl;
+  for (size_t i = 0; i < layouts.size(); i++) {
+    for (auto& wave : summaries[i]) {
+      os << layouts[i].name << "," << wave.wave << "," << wave.runs << ","
+         << wave.leak_rate << "," << wave.lives_lost << "," << wave.money
+         << "," << wave.time_to_clear << "," << wave.survival << std::endl;
+    }
+  }
+}
+
+void WriteJson(std::ostream& os, const std::string& map_name,
+               const std::vector<Layout>& layouts,
+               const std::vector<std::vector<WaveSummary>>& summaries) {
+  os << "{\n  \"map\": \"" << map_name << "\",\n  \"layouts\": [";
+  for (size_t i = 0; i < layouts.size(); i++) {
+    os << (i ? "," : "") << "\n    {\n      \"name\": \"" << layouts[i].name
+       << "\",\n      \"waves\": [";
+    for (size_t j = 0; j < summaries[i].size(); j++) {
+      const WaveSummary& wave = summaries[i][j];
+      os << (j ? "," : "") << "\n        {\"wave\": " << wave.wave
+         << ", \"runs\": " << wave.runs
+         << ", \"leak_rate\": " << wave.leak_rate
+         << ", \"lives_lost\": " << wave.lives_lost
+         << ", \"money\": " << wave.money
+         << ", \"time_to_clear\": " << wave.time_to_clear
+         << ", \"survival\": " << wave.survival << "}";
+    }
+    os << "\n      ]\n    }";
+  }
+  os << "\n  ]\n}" << std::endl;
+}
+
+void PrintUsage() {
+  std::cout << "Usage: td-balance <map name> <layouts file> [--runs count] "
+               "[--jitter tiles] [--lives count] [--seed number] "
+               "[--threads count] [--format csv|json] [--output file] "
+               "[--map-file file] [--waves-file file] [--towers-file file]"
+            << std::endl;
+}
+}  // namespace
+
+// Plays the waves of a map headlessly against tower layouts and reports how
+// each wave went on average. Run it from the out directory like the game,
+// e.g. "td-balance 01 maps/01/layouts.json --runs 1000".
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    PrintUsage();
+    return 1;
+  }
+  std::string name = argv[1];
+  std::string layouts_file = argv[2];
+  Options options;
+  for (int i = 3; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--runs" && i + 1 < argc) {
+      options.runs = std::atoi(argv[++i]);
+    } else if (arg == "--jitter" && i + 1 < argc) {
+      options.jitter = std::atoi(argv[++i]);
+    } else if (arg == "--lives" && i + 1 < argc) {
+      options.lives = std::atoi(argv[++i]);
+    } else if (arg == "--seed" && i + 1 < argc) {
+      options.seed = std::atoi(argv[++i]);
+    } else if (arg == "--threads" && i + 1 < argc) {
+      options.threads = std::atoi(argv[++i]);
+    } else if (arg == "--format" && i + 1 < argc) {
+      options.format = argv[++i];
+    } else if (arg == "--output" && i + 1 < argc) {
+      options.output = argv[++i];
+    } else if (arg == "--map-file" && i + 1 < argc) {
+      options.map_file = argv[++i];
+    } else if (arg == "--waves-file" && i + 1 < argc) {
+      options.waves_file = argv[++i];
+    } else if (arg == "--towers-file" && i + 1 < argc) {
+      options.towers_file = argv[++i];
+    } else {
+      PrintUsage();
+      return 1;
+    }
+  }
+  if (options.format != "csv" && options.format != "json") {
+    PrintUsage();
+    return 1;
+  }
+
+  Map map;
+  map.SetName(name);
+  map.Load(options.map_file);
+  if (map.GetPath().empty()) {
+    std::cout << "Failed to load the map " << name << std::endl;
+    return 1;
+  }
+  if (!wave_manager.ParseFile("maps/" + name + "/" + options.waves_file)) {
+    std::cout << "Failed to load the waves of " << name << std::endl;
+    return 1;
+  }
+  map.SetWaves(wave_manager.GetWaves());
+  std::string towers_error;
+  bool towers_loaded =
+      options.towers_file.empty()
+          ? config_manager->LoadTowers(name, towers_error)
+          : config_manager->ParseTowers(options.towers_file, towers_error);
+  if (!towers_loaded) {
+    std::cout << towers_error << std::endl;
+    return 1;
+  }
+  const TowerTable& tower_table = config_manager->GetTowers();
+  std::vector<Layout> layouts;
+  if (!LoadLayouts(layouts_file, map, tower_table, layouts)) {
+    return 1;
+  }
+
+  // Every run gets its own random placement from the seed and its number, so
+  // the results don't depend on the number of threads
+  JobSystem jobs(options.threads);
+  std::vector<std::vector<WaveSummary>> summaries;
+  unsigned long enemy_steps = 0;
+  std::atomic<bool> failed(false);
+  auto start = std::chrono::steady_clock::now();
+  for (auto& layout : layouts) {
+    std::vector<RunResult> runs(options.runs);
+    jobs.ParallelFor(options.runs, 1, [&](int begin, int end, int) {
+      for (int run = begin; run < end; run++) {
+        std::mt19937 rng(options.seed + run);
+        if (!Simulate(map, tower_table,
+                      Randomize(map, layout, options.jitter, rng), options,
+                      runs[run])) {
+          failed = true;
+        }
+      }
+    });
+    if (failed) {
+      std::cout << layout.name << ": A run couldn't place its towers"
+                << std::endl;
+      return 1;
+    }
+    for (auto& run : runs) {
+      enemy_steps += run.enemy_steps;
+    }
+    summaries.push_back(Summarize(runs, options.lives));
+  }
+  float seconds = std::chrono::duration<float>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+  std::cerr << layouts.size() * options.runs << " runs, " << enemy_steps
+            << " enemy steps in " << seconds << " s ("
+            << enemy_steps / seconds << " per second)" << std::endl;
+
+  std::ofstream file;
+  if (!options.output.empty()) {
+    file.open(options.output);
+    if (!file.is_open()) {
+      std::cout << "Failed to open " << options.output << std::endl;
+      return 1;
+    }
+  }
+  std::ostream& os = options.output.empty() ? std::cout : file;
+  if (options.format == "csv") {
+    WriteCsv(os, layouts, summaries);
+  } else {
+    WriteJson(os, name, layouts, summaries);
+  }
+  return 0;
+}
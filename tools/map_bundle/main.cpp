@@ -0,0 +1,41 @@
+#include <iostream>
+#include <string>
+#include "game/wavemanager.hpp"
+#include "map/map.hpp"
+
+// Converts a map and its waves into a binary map bundle. Run it from the out
+// directory like the game, e.g. "td-map-bundle 01" writes maps/01/map.bundle.
+int main(int argc, char** argv) {
+  if (argc < 2 || argc > 5) {
+    std::cout << "Usage: td-map-bundle <map name> [map file] [waves file] "
+                 "[bundle file]"
+              << std::endl;
+    return 1;
+  }
+  std::string name = argv[1];
+  std::string map_file = argc > 2 ? argv[2] : "map.txt";
+  std::string waves_file = argc > 3 ? argv[3] : "waves.json";
+  std::string bundle_file =
+      argc > 4 ? argv[4] : "maps/" + name + "/map.bundle";
+
+  Map map;
+  map.SetName(name);
+  map.Load(map_file);
+  if (map.GetPath().empty()) {
+    std::cout << "Failed to load the map " << name << std::endl;
+    return 1;
+  }
+  if (!wave_manager.ParseFile("maps/" + name + "/" + waves_file)) {
+    std::cout << "Failed to load the waves of " << name << std::endl;
+    return 1;
+  }
+  const WaveTable& waves = wave_manager.GetWaves();
+  map.SetWaves(waves);
+  if (!map.SaveBundle(bundle_file)) {
+    return 1;
+  }
+  std::cout << "Wrote " << bundle_file << ": " << map.GetWidth() << "x"
+            << map.GetHeight() << " tiles, " << waves.GetWaveCount()
+            << " waves" << std::endl;
+  return 0;
+}
@@ -0,0 +1,140 @@
+#include <boost/filesystem.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "configuration/configmanager.hpp"
+#include "game/wavemanager.hpp"
+#include "map/map.hpp"
+#include "simulation/job_system.hpp"
+#include "simulation/replay.hpp"
+#include "simulation/simulation.hpp"
+
+namespace {
+// Loads the map the way the game does, from its bundle if there is one
+bool LoadMap(const std::string& name, Map& map) {
+  std::string config_error;
+  if (!config_manager->ParseFile("settings.json", config_error)) {
+    std::cout << "Failed to parse configuration file." << std::endl;
+  }
+  map.SetName(name);
+  std::string bundle = "maps/" + name + "/" +
+                       config_manager->GetValueOrDefault<std::string>(
+                           "maps/" + name + "/bundle", "map.bundle");
+  if (boost::filesystem::exists(bundle) && map.LoadBundle(bundle)) {
+    return true;
+  }
+  map.Load(config_manager->GetValueOrDefault<std::string>(
+      "maps/" + name + "/file", "map.txt"));
+  if (map.GetPath().empty() ||
+      !wave_manager.ParseFile(
+          "maps/" + name + "/" +
+          config_manager->GetValueOrDefault<std::string>(
+              "maps/" + name + "/waves", "waves.json"))) {
+    return false;
+  }
+  map.SetWaves(wave_manager.GetWaves());
+  return true;
+}
+}  // namespace
+
+// Plays a replay recorded by the game as fast as possible and checks that
+// every step ends in the state it had when it was recorded. Run it from the
+// out directory like the game, e.g. "td-replay last_game.replay".
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cout << "Usage: td-replay <replay file> [--no-check] "
+                 "[--threads count]"
+              << std::endl;
+    return 1;
+  }
+  std::string file_path = argv[1];
+  bool check = true;
+  int threads = 1;
+  for (int i = 2; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--no-check") {
+      check = false;
+    } else if (arg == "--threads" && i + 1 < argc) {
+      threads = std::atoi(argv[++i]);
+    } else {
+      std::cout << "Unknown argument " << arg << std::endl;
+      return 1;
+    }
+  }
+
+  Replay::Reader reader;
+  if (!reader.Open(file_path)) {
+    return 1;
+  }
+  Map map;
+  if (!LoadMap(reader.GetMapName(), map)) {
+    std::cout << "Failed to load the map " << reader.GetMapName()
+              << std::endl;
+    return 1;
+  }
+  if (Replay::HashMap(map) != reader.GetMapHash()) {
+    std::cout << "The map " << reader.GetMapName()
+              << " changed since the replay was recorded" << std::endl;
+    return 1;
+  }
+  std::string towers_error;
+  if (!config_manager->LoadTowers(reader.GetMapName(), towers_error)) {
+    std::cout << towers_error << std::endl;
+    return 1;
+  }
+  if (Replay::HashTowers(config_manager->GetTowers()) !=
+      reader.GetTowersHash()) {
+    std::cout << "The tower stats changed since the replay was recorded"
+              << std::endl;
+    return 1;
+  }
+
+  std::unique_ptr<JobSystem> jobs;
+  Simulation simulation(map, reader.GetPlayer(),
+                        config_manager->GetTowers());
+  if (threads > 1) {
+    jobs.reset(new JobSystem(threads));
+    simulation.SetJobSystem(jobs.get());
+  }
+  auto start = std::chrono::steady_clock::now();
+  unsigned long enemy_steps = 0;
+  Replay::Entry entry;
+  while (reader.Next(entry)) {
+    while (simulation.GetStep() < entry.step) {
+      simulation.Step();
+      enemy_steps += simulation.GetEnemies().Size();
+    }
+    if (entry.type == Replay::StateHashEntry) {
+      if (check && simulation.GetStateHash() != entry.hash) {
+        std::cout << "The state differs from the recording at step "
+                  << entry.step << std::endl;
+        return 1;
+      }
+    } else if (!Replay::Apply(entry, simulation)) {
+      std::cout << "The simulation refused a recorded command at step "
+                << entry.step << std::endl;
+      return 1;
+    }
+  }
+  if (reader.IsBroken()) {
+    std::cout << file_path << ": Broken entry after step "
+              << simulation.GetStep() << std::endl;
+    return 1;
+  }
+  float seconds = std::chrono::duration<float>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+
+  const Player& player = simulation.GetPlayer();
+  std::cout << "Replayed " << simulation.GetStep() << " steps in " << seconds
+            << " s (" << simulation.GetStep() / seconds << " steps, "
+            << enemy_steps / seconds << " enemy steps per second)"
+            << std::endl;
+  std::cout << "Wave " << simulation.GetWave() << ", money "
+            << player.GetMoney() << ", lives " << player.GetLives()
+            << (check ? ", every step matched the recording" : "")
+            << std::endl;
+  return 0;
+}